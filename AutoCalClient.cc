@@ -37,9 +37,16 @@
 #include <gsl/gsl_statistics_float.h>
 #include <gsl/gsl_fit.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <ctime>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <set>
+#include <thread>
 #include <unistd.h>
 
 #include <QTextStream>
@@ -49,48 +56,43 @@ typedef unsigned char uchar;
 
 #define TDELAY 10 // time delay after setting a new voltage (seconds)
 
+// A channel is given up on when it has not filled within
+// WATCHDOG_FACTOR times its expected gather time plus WATCHDOG_SLACK seconds.
+#define WATCHDOG_FACTOR 2
+#define WATCHDOG_SLACK 5
+
+static const char checkpointMagic[4] = { 'A', 'C', 'K', '3' };
+
 using namespace XmlRpc;
 namespace n_u = nidas::util;
 
-string fillStateDesc[] = {"SKIP", "PEND", "EMPTY", "FULL" };
+string fillStateDesc[] = {"SKIP", "PEND", "EMPTY", "FULL", "FAILED" };
+
+static const string noVarName("---");
+static const string noTimeStamp("---- --- -- --:--:--");
+static const vector<double> noCals;
+
+// Walk a chain of nested maps without inserting anything.
+// Returns a pointer to the innermost value, or 0 if any key is missing.
+template <typename M, typename K, typename... Ks>
+static auto lookup(M& m, const K& k, const Ks&... ks)
+{
+    auto it = m.find(k);
+    if constexpr (sizeof...(ks) == 0)
+        return (it == m.end()) ? 0 : &it->second;
+    else
+        return (it == m.end()) ? 0 : lookup(it->second, ks...);
+}
 
 AutoCalClient::AutoCalClient():
    nLevels(0),
    progress(1),
+   remaining(-1),
    testVoltage(false),
-   idxVltLvl(-1),
-   VltLvl(0)
+   resultThreads(0),
+   levelOrdering(ORDER_COMMON),
+   usedOrder(ORDER_COMMON)
 {
-    list <int> volts;
-    voltageLevels["--"] = volts;
-
-    volts.push_back(0);
-    volts.push_back(2);
-    voltageLevels["gpDAQ"] = volts;
-
-    volts.clear();
-    volts.push_back(0);
-    volts.push_back(1);
-    volts.push_back(5);
-    voltageLevels["dmmat"] = volts;
-    voltageLevels["4F"] = volts;
-    voltageLevels["2T"] = volts;
-
-    volts.push_back(10);
-    voltageLevels["2F"] = volts;
-
-    volts.push_back(-10);
-    voltageLevels["1T"] = volts;
-
-    volts.clear();
-    volts.push_back(-99);
-    volts.push_back(0);
-    volts.push_back(1);
-    volts.push_back(2);
-    volts.push_back(5);
-    volts.push_back(10);
-    volts.push_back(-10);
-    voltageLevels["XX"] = volts;
 };
 
 
@@ -112,47 +114,47 @@ void AutoCalClient::setTestVoltage(int dsmId, int devId)
 };
 
 
-bool AutoCalClient::readCalFile(DSMSensor* sensor, string card)
+void AutoCalClient::ReadCalHistory(DSMSensor* sensor, const SensorProbe& probe,
+                                   CalHistory& history) const
 {
-    std::cout << "AutoCalClient::readCalFile(" << sensor->getDSMName() << ":" << sensor->getDeviceName() << ")" << std::endl;
-    uint dsmId = sensor->getDSMId();
-    uint devId = sensor->getSensorId();
-    int N = devNchannels[id(dsmId, devId)];
+    ostringstream& ostr = history.log;
+    ostr << "AutoCalClient::ReadCalHistory(" << sensor->getDSMName() << ":" << sensor->getDeviceName() << ")" << std::endl;
+    int N = probe.nChannels;
+    const string& card = probe.card;
 
     dsm_time_t sysTime, calTime = 0;
-    ostringstream ostr;
 
     // pre-fill with '0' in case a calFile is missing an entry
     // create unused (gain bplr) entries for (1 0) and (4 1) anyway
     for (int gain = 0; gain < 3; gain++) {
         for (int bplr = 0; bplr < 2; bplr++) {
-            calFileTime[dsmId][devId][1<<gain][bplr] = calTime;
+            history.time[1<<gain][bplr] = calTime;
 
             // pre set with default slope and intercept values.
             for (int i = 0; i < N; i++) {
-                calFileCals[dsmId][devId][i][1<<gain][bplr].clear();
-                calFileCals[dsmId][devId][i][1<<gain][bplr].push_back(0.0);
-                calFileCals[dsmId][devId][i][1<<gain][bplr].push_back(1.0);
+                history.cals[i][1<<gain][bplr].clear();
+                history.cals[i][1<<gain][bplr].push_back(0.0);
+                history.cals[i][1<<gain][bplr].push_back(1.0);
             }
         }
     }
     const map<string,CalFile *>& cfs = sensor->getCalFiles();
     if (cfs.empty()) {
-        ostr << "CalFile not set for..." << std::endl;
-        ostr << "DSM: " << sensor->getDSMName() << " device: " << sensor->getDeviceName() << std::endl;
-        std::cout << ostr.str() << std::endl;
-        QMessageBox::warning(0, "CalFile ERROR", ostr.str().c_str());
-        return true;
+        ostringstream err;
+        err << "CalFile not set for..." << std::endl;
+        err << "DSM: " << sensor->getDSMName() << " device: " << sensor->getDeviceName() << std::endl;
+        ostr << err.str() << std::endl;
+        history.warnings.push_back(make_pair(string("CalFile ERROR"), err.str()));
+        return;
     }
     CalFile *cf = cfs.begin()->second;
 
     // extract the A2D board serial number from its CalFile
-    calFilePath[dsmId][devId] =
-      Project::getInstance()->expandString( cf->getPath() );
-    calFileName[dsmId][devId] = cf->getFile();
+    history.path = Project::getInstance()->expandString( cf->getPath() );
+    history.file = cf->getFile();
 
-    ostr << "calFilePath: " << calFilePath[dsmId][devId] << std::endl;
-    ostr << "calFileName: " << calFileName[dsmId][devId] << std::endl;
+    ostr << "calFilePath: " << history.path << std::endl;
+    ostr << "calFileName: " << history.file << std::endl;
 
     // get system time
     struct timeval tv;
@@ -168,45 +170,42 @@ bool AutoCalClient::readCalFile(DSMSensor* sensor, string card)
     else
         nCals = 2; // all else are mx+b
     int nd = 2 + N * nCals;
-    float d[nd];
+    vector<float> d(nd);
     while (sysTime >= cf->nextTime().toUsecs())
     {
         try {
             n_u::UTime ut;
-            int n = cf->readCF(ut, d, nd);
+            int n = cf->readCF(ut, &d[0], nd);
             calTime = ut.toUsecs();
             if (n < 2) continue;
 
             int gain = (int)d[0];
             int bplr = (int)d[1];
 
-            calFileTime[dsmId][devId][gain][bplr] = calTime;
+            history.time[gain][bplr] = calTime;
             // This does not coorectly push_back 4 cals.
             for (int i = 0; i < std::min((n-2)/nCals, N); i++) {
-                calFileCals[dsmId][devId][i][gain][bplr].clear();
-                calFileCals[dsmId][devId][i][gain][bplr].push_back(d[2+i*nCals]);
-                calFileCals[dsmId][devId][i][gain][bplr].push_back(d[3+i*nCals]);
+                history.cals[i][gain][bplr].clear();
+                history.cals[i][gain][bplr].push_back(d[2+i*nCals]);
+                history.cals[i][gain][bplr].push_back(d[3+i*nCals]);
             }
         }
         catch(const n_u::EOFException& e)
         {
-            ostr << e.what();
-            std::cout << ostr.str() << std::endl;
-            QMessageBox::warning(0, "CalFile ERROR", ostr.str().c_str());
+            ostr << e.what() << std::endl;
+            history.warnings.push_back(make_pair(string("CalFile ERROR"), string(e.what())));
             break;
         }
         catch(const n_u::IOException& e)
         {
-            ostr << e.what();
-            std::cout << ostr.str() << std::endl;
-            QMessageBox::warning(0, "CalFile ERROR", ostr.str().c_str());
+            ostr << e.what() << std::endl;
+            history.warnings.push_back(make_pair(string("CalFile ERROR"), string(e.what())));
             break;
         }
         catch(const n_u::ParseException& e)
         {
-            ostr << e.what();
-            std::cout << ostr.str() << std::endl;
-            QMessageBox::warning(0, "CalFile ERROR", ostr.str().c_str());
+            ostr << e.what() << std::endl;
+            history.warnings.push_back(make_pair(string("CalFile ERROR"), string(e.what())));
             break;
         }
     }
@@ -215,6 +214,27 @@ bool AutoCalClient::readCalFile(DSMSensor* sensor, string card)
         cf->close();
         cf->open();
     }
+}
+
+
+bool AutoCalClient::StoreCalHistory(DSMSensor* sensor, const CalHistory& history)
+{
+    uint dsmId = sensor->getDSMId();
+    uint devId = sensor->getSensorId();
+
+    std::cout << history.log.str();
+
+    calFileTime[dsmId][devId] = history.time;
+
+    map<uint, map<uint, map<uint, vector<double> > > >::const_iterator iC;
+    for (iC = history.cals.begin(); iC != history.cals.end(); iC++)
+        calFileCals[dsmId][devId][iC->first] = iC->second;
+
+    if (history.file.empty())
+        return true;
+
+    calFilePath[dsmId][devId] = history.path;
+    calFileName[dsmId][devId] = history.file;
     return false;
 }
 
@@ -229,28 +249,22 @@ a2d_setup AutoCalClient::GetA2dSetup(int dsmId, int devId)
     std::cout << "AutoCalClient::GetA2dSetup dsmName: " << dsmName << " devName: " << devName << std::endl;
 
 #ifndef SIMULATE
-    // establish an xmlrpc connection to this DSM
-    XmlRpcClient dsm_xmlrpc_client(dsmName.c_str(),
-                                   DSM_XMLRPC_PORT_TCP, "/RPC2");
-
     // fetch the current setup from the card itself
     XmlRpcValue get_params, get_result;
     get_params["device"] = devName;
     get_params["action"] = "getA2DSetup";
     std::cout << "  get_params: " << get_params.toXml() << std::endl;
 
-    if (dsm_xmlrpc_client.execute("SensorAction", get_params, get_result)) {
-        if (dsm_xmlrpc_client.isFault()) {
-            ostringstream ostr;
-            ostr << get_result["faultString"] << std::endl;
-            ostr << "ignoring: " << dsmName << ":" << devName;
-            std::cout << ostr.str() << std::endl;
-            QMessageBox::warning(0, "xmlrpc client fault", ostr.str().c_str());
-
-            dsm_xmlrpc_client.close();
-            return setup;
-        }
-        dsm_xmlrpc_client.close();
+    enum rpcStatus status = control.execute(dsmName, "SensorAction", get_params, get_result);
+    if (status == RPC_FAULT) {
+        ostringstream ostr;
+        ostr << get_result["faultString"] << std::endl;
+        ostr << "ignoring: " << dsmName << ":" << devName;
+        std::cout << ostr.str() << std::endl;
+        QMessageBox::warning(0, "xmlrpc client fault", ostr.str().c_str());
+        return setup;
+    }
+    if (status == RPC_OK) {
         nChannels = get_result["nChannels"];
         for (int i = 0; i < nChannels; i++) {
             setup.gain[i]   = get_result["gain"][i];
@@ -260,7 +274,7 @@ a2d_setup AutoCalClient::GetA2dSetup(int dsmId, int devId)
         setup.vcal = get_result["vcal"];
     }
     else {
-        std::cout << "xmlrpc client NOT responding" << std::endl;
+        std::cout << "xmlrpc client " << XmlRpcControl::describe(status) << std::endl;
     }
 #else
     for (int i = 0; i < nChannels; i++) {
@@ -280,11 +294,6 @@ void AutoCalClient::TestVoltage(int channel, int level)
          << dsmNames[tvDsmId] << ":" << devNames[id(tvDsmId, tvDevId)] << ":"
          << ChnSetDesc(1 << channel) << ":" << level << "v" << std::endl;
 
-#ifndef SIMULATE
-    XmlRpcClient dsm_xmlrpc_client(dsmNames[tvDsmId].c_str(),
-                                   DSM_XMLRPC_PORT_TCP, "/RPC2");
-#endif
-
     XmlRpcValue set_params, set_result;
     set_params["device"] = devNames[id(tvDsmId, tvDevId)];
     set_params["action"] = "testVoltage";
@@ -296,90 +305,103 @@ void AutoCalClient::TestVoltage(int channel, int level)
 
 #ifndef SIMULATE
     // Instruct card to generate a calibration voltage.
-    if (dsm_xmlrpc_client.execute("SensorAction", set_params, set_result)) {
-        if (dsm_xmlrpc_client.isFault()) {
-            std::cout << "xmlrpc client fault: " << set_result["faultString"] << std::endl;
-        }
-    }
-    else {
-        std::cout << "xmlrpc client NOT responding" << std::endl;
-    }
-    dsm_xmlrpc_client.close();
+    enum rpcStatus status = control.execute(dsmNames[tvDsmId], "SensorAction", set_params, set_result);
+    if (status == RPC_FAULT)
+        std::cout << "xmlrpc client fault: " << set_result["faultString"] << std::endl;
+    else if (status != RPC_OK)
+        std::cout << "xmlrpc client " << XmlRpcControl::describe(status) << std::endl;
     std::cout << "set_result: " << set_result.toXml() << std::endl;
 #endif
     emit updateSelection();
 }
 
 
-bool AutoCalClient::Setup(DSMSensor* sensor)
+enum rpcStatus AutoCalClient::Probe(DSMSensor* sensor, SensorProbe& probe)
 {
-    std::cout << "AutoCalClient::Setup(" << sensor->getDSMName() << ":" << sensor->getDeviceName() << ")" << std::endl;
-
-    string dsmName = sensor->getDSMName();
-    string devName = sensor->getDeviceName();
-
-    uint dsmId = sensor->getDSMId();
-    uint devId = sensor->getSensorId();
+    probe.status = RPC_OK;
+    probe.nChannels = 0;
 
 #ifndef SIMULATE
-    // establish an xmlrpc connection to this DSM
-    XmlRpcClient dsm_xmlrpc_client(dsmName.c_str(),
-                                   DSM_XMLRPC_PORT_TCP, "/RPC2");
-
     // fetch the current setup from the card itself
     XmlRpcValue get_params, get_result;
-    get_params["device"] = devName;
+    get_params["device"] = sensor->getDeviceName();
     get_params["action"] = "getA2DSetup";
-    std::cout << "  get_params: " << get_params.toXml() << std::endl;
-    a2d_setup setup;
-    int nChannels = 0;
 
     try {
-        if (dsm_xmlrpc_client.execute("SensorAction", get_params, get_result)) {
-            if (dsm_xmlrpc_client.isFault()) {
-                ostringstream ostr;
-                ostr << get_result["faultString"] << std::endl;
-                ostr << "ignoring: " << dsmName << ":" << devName;
-                QMessageBox::warning(0, "xmlrpc client fault", ostr.str().c_str());
-
-                dsm_xmlrpc_client.close();
-                return true;
-            }
-            dsm_xmlrpc_client.close();
-            nChannels = get_result["nChannels"];
-            for (int i = 0; i < nChannels; i++) {
-                setup.gain[i]   = get_result["gain"][i];
-                setup.offset[i] = get_result["offset"][i];
-                setup.calset[i] = get_result["calset"][i];
-            }
-            setup.vcal = get_result["vcal"];
-#ifdef DONT_IGNORE_ACTIVE_CARDS
-            if (setup.vcal != -99) {
-                // TODO ensure that a -99 is reported back by the driver when nothing is active.
-                ostringstream ostr;
-                ostr << "A calibration voltage is active here.  Cannot auto calibrate this." << std::endl;
-                ostr << "ignoring: " << dsmName << ":" << devName;
-                std::cout << ostr.str() << std::endl;
-                QMessageBox::warning(0, "card is busy", ostr.str().c_str());
-                return true;
-            }
-#endif
-        }
-        else {
-            ostringstream ostr;
-            ostr << get_result["faultString"] << std::endl;
-            ostr << "ignoring: " << dsmName << ":" << devName;
-            std::cout << ostr.str() << std::endl;
-//            QMessageBox::warning(0, "xmlrpc client NOT responding", ostr.str().c_str());
-            return true;
-        }
+        probe.status = control.execute(sensor->getDSMName(), "SensorAction", get_params, get_result);
     }
     catch (XmlRpc::XmlRpcException& e)
     {
         std::cout << "(" << e.getCode() << ") " << e.getMessage() << std::endl;
+        probe.status = RPC_NO_RESPONSE;
+        return probe.status;
+    }
+    if (probe.status == RPC_FAULT) {
+        ostringstream ostr;
+        ostr << get_result["faultString"];
+        probe.fault = ostr.str();
+    }
+    else if (probe.status == RPC_OK) {
+        probe.nChannels = get_result["nChannels"];
+        for (int i = 0; i < probe.nChannels; i++) {
+            probe.setup.gain[i]   = get_result["gain"][i];
+            probe.setup.offset[i] = get_result["offset"][i];
+            probe.setup.calset[i] = get_result["calset"][i];
+        }
+        probe.setup.vcal = get_result["vcal"];
+        string card = get_result["card"];
+        probe.card = card;
+    }
+#endif
+    return probe.status;
+}
+
+
+bool AutoCalClient::Setup(DSMSensor* sensor, const SensorProbe& probe,
+                          pair<string, string>& failure)
+{
+    std::cout << "AutoCalClient::Setup(" << sensor->getDSMName() << ":" << sensor->getDeviceName() << ")" << std::endl;
+
+    string dsmName = sensor->getDSMName();
+    string devName = sensor->getDeviceName();
+
+    uint dsmId = sensor->getDSMId();
+    uint devId = sensor->getSensorId();
+
+    const string& card = probe.card;
+    int nChannels = probe.nChannels;
+
+#ifndef SIMULATE
+    const a2d_setup& setup = probe.setup;
+
+    if (probe.status == RPC_FAULT) {
+        ostringstream ostr;
+        ostr << probe.fault << std::endl;
+        ostr << "ignoring: " << dsmName << ":" << devName;
+        std::cout << ostr.str() << std::endl;
+        failure = make_pair(string("xmlrpc client fault"), ostr.str());
+        return true;
+    }
+    if (probe.status != RPC_OK) {
+        ostringstream ostr;
+        ostr << "xmlrpc client " << XmlRpcControl::describe(probe.status) << std::endl;
+        ostr << "ignoring: " << dsmName << ":" << devName;
+        std::cout << ostr.str() << std::endl;
+        failure = make_pair(string("xmlrpc client NOT responding"), ostr.str());
+        return true;
+    }
+#ifdef DONT_IGNORE_ACTIVE_CARDS
+    if (setup.vcal != -99) {
+        // TODO ensure that a -99 is reported back by the driver when nothing is active.
+        ostringstream ostr;
+        ostr << "A calibration voltage is active here.  Cannot auto calibrate this." << std::endl;
+        ostr << "ignoring: " << dsmName << ":" << devName;
+        std::cout << ostr.str() << std::endl;
+        failure = make_pair(string("card is busy"), ostr.str());
         return true;
     }
-    std::cout << "get_result: " << get_result.toXml() << std::endl;
+#endif
+    std::cout << "card: " << card << " nChannels: " << nChannels << std::endl;
 #endif
 
     /* Parse XML for this sensor, validate against info returned from dsm/class above.
@@ -387,7 +409,6 @@ bool AutoCalClient::Setup(DSMSensor* sensor)
      */
     list<SampleTag*>& tags = sensor->getSampleTags();
     list<SampleTag*>::const_iterator ti;
-    string card = get_result["card"];
     for (ti = tags.begin(); ti != tags.end(); ++ti) {
         SampleTag* tag = *ti;
 
@@ -444,16 +465,15 @@ bool AutoCalClient::Setup(DSMSensor* sensor)
                      << "(you need to reboot this DSM)" << std::endl
                      << "ignoring: " << dsmName << ":" << devName;
                 std::cout << ostr.str() << std::endl;
-                QMessageBox::warning(0, "miss-configured card", ostr.str().c_str());
+                failure = make_pair(string("miss-configured card"), ostr.str());
                 return true;
             }
 #endif
-            // channel is available
-            ostringstream gb;
-            if (card == "gpDAQ")
-                gb << card;
-            else
-                gb << gain << (bplr ? "T" : "F");
+            // channel is available; a dmmat is calibrated at the levels of
+            // its gain range, though its test page offers the dmmat plan
+            int code = VoltagePlans::Code(card, gain, bplr);
+            const VoltagePlans::Plan& plan =
+              plans.get(card == "dmmat" ? VoltagePlans::Code("", gain, bplr) : code);
 
             sampleInfo[sampId].channel[varId++] = channel;
 
@@ -461,11 +481,12 @@ bool AutoCalClient::Setup(DSMSensor* sensor)
             VarNames[dsmId][devId][channel] = var.getName();
             Gains[dsmId][devId][channel] = gain;
             Bplrs[dsmId][devId][channel] = bplr;
+            PlanCodes[dsmId][devId][channel] = code;
 
             std::cout << "AutoCalClient::Setup channel: " << channel << " gain: " << gain << " bplr: " << bplr << std::endl;
 
-            list<int>::iterator l;
-            for ( l = voltageLevels[gb.str()].begin(); l != voltageLevels[gb.str()].end(); l++) {
+            const int* l;
+            for ( l = plan.begin(); l != plan.end(); l++) {
 
                 calActv[*l][dsmId][devId][channel] = PEND;
                 calData[dsmId][devId][channel][*l].reserve( NSAMPS * sizeof(float) );
@@ -480,8 +501,8 @@ bool AutoCalClient::Setup(DSMSensor* sensor)
                 if (slowestRate[*l] > tag->getRate())
                     slowestRate[*l] = (uint) tag->getRate();
             }
-            if (nLevels < voltageLevels[gb.str()].size())
-                nLevels = voltageLevels[gb.str()].size();
+            if (nLevels < plan.size())
+                nLevels = plan.size();
             std::cout << "nLevels: " << nLevels << std::endl;
         }
         sampleInfo[sampId].dsmId = dsmId;
@@ -495,16 +516,16 @@ bool AutoCalClient::Setup(DSMSensor* sensor)
     }
 
     dsmNames[dsmId] = dsmName;
+    clocks.addDsm(dsmId, dsmName);
     devNames[id(dsmId, devId)] = devName;
+    metrics.addCard(id(dsmId, devId), dsmName + ":" + devName);
     devNchannels[id(dsmId, devId)] = nChannels;
     cardType[id(dsmId, devId)] = card;
-    lastTimeStamp = 0;
-
-    readCalFile(sensor, card);
 
-    list<int>::iterator l;
-    for ( l = voltageLevels["1T"].begin(); l != voltageLevels["1T"].end(); l++)
-        std::cout << "slowestRate[" << *l << "]: " << slowestRate[*l] << std::endl;
+    const int* l;
+    for ( l = plans.selectable().begin(); l != plans.selectable().end(); l++)
+        if (slowestRate.count(*l))
+            std::cout << "slowestRate[" << *l << "]: " << slowestRate[*l] << std::endl;
 
     return false;
 }
@@ -550,125 +571,402 @@ void AutoCalClient::createQtTreeModel( map<dsm_sample_id_t, string>dsmLocations
             }
         }
     }
-    // start the Voltage level index
-    iLevel = calActv.begin();
+    // start each DSM's voltage level sequence
+    StartSequences();
+
+    BuildResultViews();
 }
 
 
-// This is a re-entrant function that advances to the next calibration voltage level.
-// It iterates across the levels, dsmNames, devNames, and Channels.
-//
-enum stateEnum AutoCalClient::SetNextCalVoltage(enum stateEnum state)
+void AutoCalClient::StartSequences()
 {
-    if (state == DONE) {
-        // Point to voltage level that is common to all voltage ranges by advancing
-        // once past the beginning.  If the range begins with '-10' then '0' is next.
-        // Or if the range begins with '0' then '1' is next.  Both '0' and '1' are common
-        // voltage levels.
-        iLevel = calActv.begin();
-        iLevel++;
-        std::cout << __PRETTY_FUNCTION__ << " DONE state... clearing all DSM's channels\n";
+    sequences.clear();
+
+    LevelScheduler::level_sets sets = LevelSets();
+    usedOrder = levelOrdering;
+    if (usedOrder == ORDER_FASTEST)
+        usedOrder = FastestOrder(sets);
+    std::cout << "level order: " << LevelScheduler::describe(usedOrder) << std::endl;
+
+    LevelScheduler::level_orders orders = LevelScheduler::Order(sets, usedOrder);
+    LevelScheduler::level_orders::const_iterator iO;
+    for (iO = orders.begin(); iO != orders.end(); iO++) {
+        Sequence& seq = sequences[iO->first];
+        seq.dsmId  = GET_DSM_ID(iO->first);
+        seq.devId  = GET_SPS_ID(iO->first);
+        seq.levels = iO->second;
     }
-    std::cout << "AutoCalClient::SetNextCalVoltage" << std::endl;
+}
 
-    if (iLevel == calActv.end() ) {
-        iLevel = calActv.begin();
-        state = DONE;
+
+LevelScheduler::level_sets AutoCalClient::LevelSets()
+{
+    LevelScheduler::level_sets sets;
+
+    for (iLevel  = calActv.begin();
+         iLevel != calActv.end(); iLevel++)
+        for (iDsm  = iLevel->second.begin();
+             iDsm != iLevel->second.end(); iDsm++)
+            for (iDevice  = iDsm->second.begin();
+                 iDevice != iDsm->second.end(); iDevice++)
+                sets[id(iDsm->first, iDevice->first)].insert(iLevel->first);
+
+    return sets;
+}
+
+
+void AutoCalClient::FillPlanner(RunPlanner& plan, const LevelScheduler::level_orders& orders)
+{
+    plan.clear();
+    plan.setSettle(TDELAY);
+    plan.setSamples(NSAMPS);
+
+    // rates[id(dsmId, devId)][chn]
+    map<dsm_sample_id_t, map<uint, uint> > rates;
+    map<dsm_sample_id_t, sA2dSampleInfo>::const_iterator iSI;
+    for (iSI = sampleInfo.begin(); iSI != sampleInfo.end(); iSI++) {
+        if (iSI->second.isaTemperatureId) continue;
+
+        map<uint, uint>::const_iterator iC;
+        for (iC = iSI->second.channel.begin(); iC != iSI->second.channel.end(); iC++)
+            rates[id(iSI->second.dsmId, iSI->second.devId)][iC->second] = iSI->second.rate;
     }
-    bool alive       = false;
-    int level        = iLevel->first;
-    dsm_a_type* Dsms = &(iLevel->second);
-    std::cout << "SNCV " << level << std::endl;
-    VltLvl = level;
 
-    // for each DSM
-    for (iDsm  = Dsms->begin();
-         iDsm != Dsms->end(); iDsm++) {
+    // each level gathers at the rate of its slowest channel
+    LevelScheduler::level_orders::const_iterator iO;
+    for (iO = orders.begin(); iO != orders.end(); iO++) {
+        uint dsmId = GET_DSM_ID(iO->first);
+        uint devId = GET_SPS_ID(iO->first);
+        vector<RunPlanner::Level> levels;
+
+        for (size_t i = 0; i < iO->second.size(); i++) {
+            RunPlanner::Level level;
+            level.level = iO->second[i];
+            level.rate = 0.0;
+
+            const channel_a_type* Channels = lookup(calActv, iO->second[i], dsmId, devId);
+            if (Channels) {
+                channel_a_type::const_iterator iC;
+                for (iC = Channels->begin(); iC != Channels->end(); iC++) {
+                    const uint* rate = lookup(rates, iO->first, iC->first);
+                    if (rate && *rate > 0 && (level.rate == 0.0 || *rate < level.rate))
+                        level.rate = *rate;
+                }
+            }
+            levels.push_back(level);
+        }
+        plan.addCard(iO->first, dsmNames[dsmId] + ":" + devNames[iO->first],
+                     dsmNames[dsmId], levels);
+    }
 
-        uint dsmId             =   iDsm->first;
-        device_a_type* Devices = &(iDsm->second);
-        std::cout << "  " << dsmId << std::endl;
+    // the probes made during setup are the first round trips to each DSM
+    map<string, XmlRpcControl::Stats> stats = control.getStats();
+    map<string, XmlRpcControl::Stats>::const_iterator iS;
+    for (iS = stats.begin(); iS != stats.end(); iS++)
+        if (iS->second.answered)
+            plan.setSwitch(iS->first, iS->second.totalLatency / iS->second.answered);
+}
 
-        // for each device
-        for (iDevice  = Devices->begin();
-             iDevice != Devices->end(); iDevice++) {
 
-            uint devId               =   iDevice->first;
-            channel_a_type* Channels = &(iDevice->second);
-            std::cout << "    " << devId << std::endl;
+enum levelOrder AutoCalClient::FastestOrder(const LevelScheduler::level_sets& sets)
+{
+    // on a tie the cards of a DSM staying in step wins
+    const enum levelOrder candidates[] = { ORDER_COMMON, ORDER_SWING, ORDER_ASCENDING };
+
+    enum levelOrder fastest = ORDER_COMMON;
+    double best = -1.0;
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        RunPlanner plan;
+        FillPlanner(plan, LevelScheduler::Order(sets, candidates[i]));
+        double seconds = plan.simulate().seconds;
+        if (best < 0.0 || seconds < best) {
+            best = seconds;
+            fastest = candidates[i];
+        }
+    }
+    return fastest;
+}
 
-#ifndef SIMULATE
-            XmlRpcClient dsm_xmlrpc_client(dsmNames[dsmId].c_str(),
-                                           DSM_XMLRPC_PORT_TCP, "/RPC2");
-#endif
 
-            XmlRpcValue set_params, set_result;
-            set_params["device"] = devNames[id(dsmId, devId)];
-            set_params["action"] = "testVoltage";
-            uchar ChnSet = 0;
+string AutoCalClient::BuildPlan()
+{
+    LevelScheduler::level_orders orders;
+    map<dsm_sample_id_t, Sequence>::const_iterator iSeq;
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++)
+        orders[iSeq->first] = iSeq->second.levels;
 
-            if (state == DONE) {
-                std::cout << "leaving cal voltages and channels in an open state" << std::endl;
-                set_params["state"] = 0;
-                set_params["voltage"] = 0;
-                ChnSet = 0xff;
-            } else {
-                set_params["state"] = 1;
-                set_params["voltage"] = level;
+    FillPlanner(planner, orders);
 
-                // for each channel
-                for (iChannel  = Channels->begin();
-                     iChannel != Channels->end(); iChannel++) {
+    planStart = RunReport::clock::now();
+    progress = 0;
+    remaining = (int)(planner.totalSeconds() + 0.5);
 
-                    uint  channel = iChannel->first;
+    // what each of the other orders would have taken
+    ostringstream ostr;
+    ostr << planner.plan() << "level orders, as simulated:\n";
+
+    LevelScheduler::level_sets sets = LevelSets();
+    for (int o = ORDER_ASCENDING; o < ORDER_FASTEST; o++) {
+        LevelScheduler::level_orders other = LevelScheduler::Order(sets, (enum levelOrder) o);
+        RunPlanner plan;
+        FillPlanner(plan, other);
+        RunPlanner::Projection p = plan.simulate();
+
+        ostr << "  " << std::left << setw(10) << LevelScheduler::describe((enum levelOrder) o)
+             << std::right << setw(8) << (int)(p.seconds + 0.5) << " s "
+             << setw(6) << p.requests << " switch requests "
+             << setw(6) << LevelScheduler::Swing(other) << " V swing"
+             << (o == usedOrder ? "  (this run)" : "") << "\n";
+    }
+    return ostr.str();
+}
 
-                    ChnSet |= (1 << channel);
-                    calActv[level][dsmId][devId][channel] = EMPTY;
 
-                    std::cout << "      ";
-                    std::cout << "ScalActv[" << level << "][" << dsmId << "][" << devId << "][" << channel << "] = ";
-                    std::cout << fillStateDesc[ calActv[level][dsmId][devId][channel] ] << std::endl;
-                }
-            }
-            std::cout << "    ";
-            std::cout << "XMLRPC ChnSet:    " << ChnSetDesc(ChnSet) << std::endl;
-            set_params["calset"] = ChnSet;
+bool AutoCalClient::SendTestVoltages(uint dsmId, const vector<TestVoltageCmd>& cmds,
+                                     vector<bool>& faults)
+{
+    faults.assign(cmds.size(), false);
+    if (cmds.empty()) return false;
+
+    vector<XmlRpcValue> set_params(cmds.size());
+    for (size_t i = 0; i < cmds.size(); i++) {
+        set_params[i]["device"] = devNames[id(dsmId, cmds[i].devId)];
+        set_params[i]["action"] = "testVoltage";
+        set_params[i]["state"] = cmds[i].state;
+        set_params[i]["voltage"] = cmds[i].level;
+        set_params[i]["calset"] = cmds[i].chnSet;
+
+        std::cout << "    " << cmds[i].devId;
+        std::cout << " XMLRPC ChnSet:    " << ChnSetDesc(cmds[i].chnSet) << std::endl;
+    }
 
 #ifndef SIMULATE
-            std::cout << " set_params: " << set_params.toXml() << std::endl;
-
-            // Instruct card to generate a calibration voltage.
-            if (dsm_xmlrpc_client.execute("SensorAction", set_params, set_result)) {
-                if (dsm_xmlrpc_client.isFault()) {
-                    std::cout << "xmlrpc client fault: " << set_result["faultString"] << std::endl;
+    XmlRpcValue set_result;
+    enum rpcStatus status;
+
+    // One round trip for all of this DSM's cards.  Each entry of the
+    // result is either a one element array holding the call's result,
+    // or a struct describing that call's fault.
+    if (cmds.size() > 1 && !noMulticall.count(dsmId)) {
+        XmlRpcValue calls, multi_params;
+        for (size_t i = 0; i < cmds.size(); i++) {
+            calls[(int)i]["methodName"] = "SensorAction";
+            calls[(int)i]["params"][0] = set_params[i];
+        }
+        multi_params[0] = calls;
+        std::cout << " multicall: " << calls.toXml() << std::endl;
 
-                    // skip other cards owned by this DSM
-                    dsm_xmlrpc_client.close();
-                    break;
+        status = control.execute(dsmNames[dsmId], "system.multicall", multi_params, set_result);
+        if (status != RPC_OK && status != RPC_FAULT) {
+            std::cout << "xmlrpc client " << XmlRpcControl::describe(status) << std::endl;
+            return true;
+        }
+        if (status == RPC_OK &&
+            set_result.getType() == XmlRpcValue::TypeArray &&
+            set_result.size() == (int)cmds.size()) {
+
+            for (size_t i = 0; i < cmds.size(); i++) {
+                XmlRpcValue& item = set_result[(int)i];
+                if (item.getType() == XmlRpcValue::TypeStruct &&
+                    item.hasMember("faultString")) {
+                    std::cout << "xmlrpc client fault: "
+                              << devNames[id(dsmId, cmds[i].devId)] << ": "
+                              << item["faultString"] << std::endl;
+                    faults[i] = true;
                 }
             }
-            else {
-                std::cout << "xmlrpc client NOT responding" << std::endl;
-
-                // skip other cards owned by this DSM
-                dsm_xmlrpc_client.close();
-                break;
-            }
-            dsm_xmlrpc_client.close();
             std::cout << "set_result: " << set_result.toXml() << std::endl;
+            return false;
+        }
+        // an older server; send this DSM one call per card from now on
+        std::cout << dsmNames[dsmId] << " does not support system.multicall" << std::endl;
+        noMulticall.insert(dsmId);
+    }
+    for (size_t i = 0; i < cmds.size(); i++) {
+        std::cout << " set_params: " << set_params[i].toXml() << std::endl;
+        set_result.clear();
+
+        // Instruct card to generate a calibration voltage.
+        status = control.execute(dsmNames[dsmId], "SensorAction", set_params[i], set_result);
+        if (status != RPC_OK && status != RPC_FAULT) {
+            std::cout << "xmlrpc client " << XmlRpcControl::describe(status) << std::endl;
+            return true;
+        }
+        if (status == RPC_FAULT) {
+            std::cout << "xmlrpc client fault: " << set_result["faultString"] << std::endl;
+            faults[i] = true;
+        }
+        else
+            std::cout << "set_result: " << set_result.toXml() << std::endl;
+    }
 #endif
-            alive = true;
+    return false;
+}
+
+
+bool AutoCalClient::StepSequences(uint dsmId, const list<Sequence*>& seqs)
+{
+    vector<TestVoltageCmd> cmds;
+    list<Sequence*>::const_iterator iSeq;
+
+    for (iSeq = seqs.begin(); iSeq != seqs.end(); iSeq++) {
+        Sequence& seq = **iSeq;
+        uint devId = seq.devId;
+
+        TestVoltageCmd cmd;
+        cmd.devId = devId;
+
+        if (seq.next == seq.levels.size()) {
+            std::cout << "SNCV " << dsmNames[dsmId] << ":" << devNames[id(dsmId, devId)]
+                      << " leaving cal voltages and channels in an open state" << std::endl;
+            cmd.state  = 0;
+            cmd.level  = 0;
+            cmd.chnSet = 0xff;
+            cmds.push_back(cmd);
+            continue;
         }
+        int level = seq.levels[seq.next];
+        channel_a_type* Channels = &(calActv[level][dsmId][devId]);
+        std::cout << "SNCV " << dsmNames[dsmId] << ":" << devNames[id(dsmId, devId)]
+                  << " " << level << std::endl;
+
+        uchar ChnSet = 0;
+
+        // for each channel
+        for (iChannel  = Channels->begin();
+             iChannel != Channels->end(); iChannel++) {
+
+            uint  channel = iChannel->first;
+
+            ChnSet |= (1 << channel);
+            iChannel->second = EMPTY;
+
+            // drop anything left over from an earlier attempt at this level
+            calData[dsmId][devId][channel][level].clear();
+
+            std::cout << "      ";
+            std::cout << "ScalActv[" << level << "][" << dsmId << "][" << devId << "][" << channel << "] = ";
+            std::cout << fillStateDesc[ iChannel->second ] << std::endl;
+        }
+        cmd.state  = 1;
+        cmd.level  = level;
+        cmd.chnSet = ChnSet;
+        cmds.push_back(cmd);
+    }
+    vector<bool> faults;
+    RunReport::clock::time_point switchStart = RunReport::clock::now();
+    bool dead;
+    {
+        Timeline::Span span(timeline, "StepSequences", dsmNames[dsmId]);
+        dead = SendTestVoltages(dsmId, cmds, faults);
+    }
+    RunReport::clock::time_point switched = RunReport::clock::now();
+    if (!cmds.empty()) {
+        double seconds = std::chrono::duration<double>(switched - switchStart).count();
+        runReport.add("voltage switch", dsmNames[dsmId], seconds);
+        if (!dead)
+            planner.observeSwitch(dsmNames[dsmId], seconds);
     }
+
+    // the cards settle from the moment their own voltage changes
     struct timeval tv;
     ::gettimeofday(&tv,0);
-    lastTimeStamp = (dsm_time_t)tv.tv_sec * USECS_PER_SEC + tv.tv_usec;
+    dsm_time_t now = (dsm_time_t)tv.tv_sec * USECS_PER_SEC + tv.tv_usec;
+
+    size_t i = 0;
+    for (iSeq = seqs.begin(); iSeq != seqs.end(); iSeq++, i++) {
+        Sequence& seq = **iSeq;
+
+        if (seq.next == seq.levels.size()) {
+            seq.active = false;
+            seq.done = true;
+        }
+        else if (dead || faults[i]) {
+            seq.active = false;
+            seq.dead = true;
+        }
+        else {
+            seq.settleStart = now;
+            seq.switched = switched;
+            seq.settling = true;
+            seq.level = cmds[i].level;
+            seq.next++;
+            seq.active = true;
+            seq.gathered = false;
+        }
+    }
+    return dead;
+}
+
+
+dsm_time_t AutoCalClient::SettleEnd(const Sequence& seq) const
+{
+    // The level was applied at host time settleStart; a skewed DSM clock
+    // would otherwise cut the settle short or drag it out.
+    return seq.settleStart - clocks.offset(seq.dsmId) + TDELAY * USECS_PER_SEC;
+}
+
+
+enum stateEnum AutoCalClient::SetNextCalVoltage(enum stateEnum state)
+{
+    std::cout << "AutoCalClient::SetNextCalVoltage" << std::endl;
+    Timeline::Span span(timeline, "SetNextCalVoltage");
+
+    map<dsm_sample_id_t, Sequence>::iterator iSeq;
+    map<uint, list<Sequence*> > ready;                 // indexed by dsmId
+    map<uint, list<Sequence*> >::iterator iReady;
+
+    if (state == DONE) {
+        std::cout << __PRETTY_FUNCTION__ << " DONE state... clearing all DSM's channels\n";
+
+        // the cards are still left open after a cancel
+        control.reset();
+
+        for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+            iSeq->second.next = iSeq->second.levels.size();
+            ready[iSeq->second.dsmId].push_back(&(iSeq->second));
+        }
+        for (iReady = ready.begin(); iReady != ready.end(); iReady++)
+            StepSequences(iReady->first, iReady->second);
+
+        return DONE;
+    }
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+
+        Sequence& seq = iSeq->second;
+
+        // still gathering its current level, or already finished
+        if (seq.dead || seq.done || (seq.active && !seq.gathered))
+            continue;
+
+        ready[seq.dsmId].push_back(&seq);
+    }
+    // Pre-stage each ready card's next level right away, so that it
+    // settles while the other cards are still gathering.  The cards
+    // of one DSM are switched together in a single request.
+    for (iReady = ready.begin(); iReady != ready.end(); iReady++) {
+
+        uint dsmId = iReady->first;
+        if (!StepSequences(dsmId, iReady->second))
+            continue;
 
-    if (!alive) return DEAD;
+        // skip other cards owned by this DSM
+        std::cout << "SNCV " << dsmNames[dsmId] << " is not responding, giving up on it" << std::endl;
+        for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++)
+            if (iSeq->second.dsmId == dsmId) {
+                iSeq->second.active = false;
+                iSeq->second.dead = true;
+            }
+    }
+    bool alive = false;
+    bool dead  = true;
 
-    // re-entrant for each level
-    iLevel++;
-    idxVltLvl++;
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+        if (!iSeq->second.dead)   dead  = false;
+        if (iSeq->second.active)  alive = true;
+    }
+    if (dead) return DEAD;
+    if (!alive) return DONE;
 
     return state;
 }
@@ -683,11 +981,6 @@ bool AutoCalClient::receive(const Sample* samp) throw()
     ::gettimeofday(&tv,0);
     currTimeStamp = samp->getTimeTag();
 
-#ifndef SIMULATE
-    if (currTimeStamp < lastTimeStamp + TDELAY * USECS_PER_SEC)
-        return false;
-#endif
-
     dsm_sample_id_t sampId = samp->getId();
     uint dsmId             = sampleInfo[sampId].dsmId;
     uint devId             = sampleInfo[sampId].devId;
@@ -695,9 +988,39 @@ bool AutoCalClient::receive(const Sample* samp) throw()
     if (dsmId == 0) { std::cout << "dsmId == 0\n"; return false; }
     if (devId == 0) { std::cout << "devId == 0\n"; return false; }
 
+    // each card settles and gathers at its own voltage level
+    int VltLvl = 0;
+    dsm_time_t since = 0;
+    if ( !testVoltage ) {
+        Sequence* seq = lookup(sequences, id(dsmId, devId));
+        if (seq == 0 || !seq->active)
+            return false;
+#ifndef SIMULATE
+        since = SettleEnd(*seq);
+        if (currTimeStamp < since) {
+            metrics.settling(id(dsmId, devId), sampleInfo[sampId].channel);
+            return false;
+        }
+#endif
+        VltLvl = seq->level;
+
+        // the first sample kept at this level ends the settle
+        if (seq->settling) {
+            seq->settling = false;
+            seq->settled = RunReport::clock::now();
+            ostringstream key;
+            key << VltLvl << "v";
+            runReport.add("settle", key.str(), seq->switched);
+        }
+    }
+
 //  std::cout << n_u::UTime(currTimeStamp).format(true,"%Y %b %d %H:%M:%S") << std::endl;
 //  std::cout << " AutoCalClient::receive " << sampId << " [" << VltLvl << "][" << dsmId << "][" << devId << "]" << std::endl;
 
+    metrics.arrived(id(dsmId, devId), sampId, sampleInfo[sampId].channel,
+                    sampleInfo[sampId].rate, currTimeStamp,
+                    (dsm_time_t)tv.tv_sec * USECS_PER_SEC + tv.tv_usec, since);
+
     const float* fp =
             (const float*) samp->getConstVoidDataPtr();
 
@@ -728,18 +1051,50 @@ bool AutoCalClient::receive(const Sample* samp) throw()
         testData[dsmId][devId][channel] = fp[varId];
 
         // ignore samples that are not currently being gathered
-        if ( calActv[VltLvl][dsmId][devId][channel] != EMPTY )
+        enum fillState* fillstate = lookup(calActv, VltLvl, dsmId, devId, channel);
+        if ( fillstate == 0 || *fillstate != EMPTY ) {
+            if ( fillstate && *fillstate == FULL )
+                metrics.afterFull(id(dsmId, devId), channel);
             continue;
+        }
 
         channelFound = true;
 
         // when testing in manual mode, don't gather data.
         if ( testVoltage ) continue;
 
+#ifndef SIMULATE
+        // Drop NaNs and switching spikes before they reach the fit.  NaNs
+        // count toward filling the level, so an out of range channel still
+        // finishes and is reported by ComputeCardResults().  A channel that
+        // keeps failing is past NSAMPS rejects and gets stored anyway.
+        numeric::RobustFilter& filter = outlierFilter[dsmId][devId][channel][VltLvl];
+        bool keep = filter.accept(fp[varId]);
+        if (!std::isfinite(fp[varId])) {
+            if (calData[dsmId][devId][channel][VltLvl].size() + filter.nonFinite() > NSAMPS-1)
+                *fillstate = FULL;
+            continue;
+        }
+        if (!keep && filter.rejected() <= NSAMPS) {
+            if (filter.rejected() == 1)
+                std::cout << "rejecting outliers on " << dsmNames[dsmId] << ":"
+                          << devNames[id(dsmId, devId)] << " channel: " << channel
+                          << " level: " << VltLvl << "v value: " << fp[varId] << std::endl;
+            continue;
+        }
+#endif
+
         // timetag first data value received
         if (timeStamp[dsmId][devId][channel] == 0)
             timeStamp[dsmId][devId][channel] = currTimeStamp;
 
+#ifndef SIMULATE
+        // the level shifted: keep the samples the filter held back, leaving room for this one
+        for (unsigned int i = 0; i < filter.recovered() &&
+               calData[dsmId][devId][channel][VltLvl].size() < NSAMPS-1; i++)
+            calData[dsmId][devId][channel][VltLvl].push_back(filter.recoveredValues()[i]);
+#endif
+
 #ifdef SIMULATE
         calData[dsmId][devId][channel][VltLvl].push_back((double)VltLvl + ((channel+1) * 0.1) );
 #else
@@ -750,13 +1105,7 @@ bool AutoCalClient::receive(const Sample* samp) throw()
 
         // stop gathering after NSAMPS received
         if (size > NSAMPS-1)
-            calActv[VltLvl][dsmId][devId][channel] = FULL;
-
-        // The progress bar to exhibits the rate of the slowest
-        // channel gathered at the current voltage level.
-        if (size)
-            if (sampleInfo[sampId].rate == slowestRate[VltLvl])
-                progress = idxVltLvl * NSAMPS + size;
+            *fillstate = FULL;
 
 //      std::cout << n_u::UTime(currTimeStamp).format(true,"%Y %b %d %H:%M:%S ");
 //      std::cout << " progress: " << progress;
@@ -778,11 +1127,129 @@ bool AutoCalClient::receive(const Sample* samp) throw()
 }
 
 
-// This funcion checks to see if enough data was gathered.
+enum rawFate AutoCalClient::RawFate(dsm_sample_id_t rawId, dsm_time_t timeTag) const
+{
+    // the test voltage page displays everything
+    if ( testVoltage ) return RAW_KEEP;
+
+    const Sequence* seq = lookup(sequences, id(GET_DSM_ID(rawId), GET_SPS_ID(rawId)));
+    if ( seq == 0 ) return RAW_KEEP;
+
+    if ( !seq->active || seq->gathered ) return RAW_IDLE;
+
+#ifndef SIMULATE
+    if ( timeTag < SettleEnd(*seq) )
+        return RAW_SETTLING;
+#endif
+    return RAW_KEEP;
+}
+
+
+// This funcion checks to see if any card has gathered enough data at
+// its current level to move on to the next one.
 //
 bool AutoCalClient::Gathered()
 {
+    Timeline::Span span(timeline, "Gathered");
+
     bool isGathered = false;
+    bool active     = false;
+
+    map<dsm_sample_id_t, Sequence>::iterator iSeq;
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+
+        Sequence& seq = iSeq->second;
+        if ( !seq.active ) continue;
+        active = true;
+
+        if ( !seq.gathered ) {
+            bool full  = false;
+            bool empty = false;
+
+            channel_a_type* Channels = &(calActv[seq.level][seq.dsmId][seq.devId]);
+            for (iChannel  = Channels->begin();
+                 iChannel != Channels->end(); iChannel++) {
+
+                enum fillState fillstate = iChannel->second;
+                if ( fillstate == FULL || fillstate == FAILED )
+                    full = true;
+                else if ( fillstate == EMPTY )
+                    empty = true;
+            }
+            if ( full && !empty ) {
+                seq.gathered = true;
+
+                // from the settle, or from the switch if nothing came in
+                ostringstream key;
+                key << seq.level << "v";
+                runReport.add("gather", key.str(), seq.settling ? seq.switched : seq.settled);
+                planner.observe(iSeq->first, seq.next - 1,
+                                std::chrono::duration<double>(RunReport::clock::now() - seq.switched).count());
+                std::cout << "AutoCalClient::Gathered " << dsmNames[seq.dsmId] << ":"
+                          << devNames[iSeq->first] << " " << seq.level << "v" << std::endl;
+            }
+        }
+        if ( seq.gathered )
+            isGathered = true;
+    }
+    UpdateProgress();
+
+    // nothing left to wait for
+    if ( !active )
+        return true;
+
+    return isGathered;
+}
+
+
+void AutoCalClient::UpdateProgress()
+{
+    RunReport::clock::time_point now = RunReport::clock::now();
+    double left = 0.0;
+
+    map<dsm_sample_id_t, Sequence>::iterator iSeq;
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+
+        Sequence& seq = iSeq->second;
+        if ( seq.dead || seq.done || seq.levels.empty() ) continue;
+
+        double seconds = planner.remainingSeconds(iSeq->first, seq.next);
+        if ( seq.active && !seq.gathered ) {
+            size_t fill = NSAMPS;
+
+            channel_a_type* Channels = &(calActv[seq.level][seq.dsmId][seq.devId]);
+            for (iChannel  = Channels->begin();
+                 iChannel != Channels->end(); iChannel++) {
+
+                if ( iChannel->second != EMPTY ) continue;
+
+                const data_d_type* data =
+                  lookup(calData, seq.dsmId, seq.devId, iChannel->first, seq.level);
+                fill = std::min(fill, data ? data->size() : 0);
+            }
+            seconds += planner.gatherSeconds(iSeq->first, seq.next - 1) * (NSAMPS - fill) / NSAMPS;
+
+            if ( seq.settling ) {
+                double since = std::chrono::duration<double>(now - seq.switched).count();
+                seconds += std::max(0.0, TDELAY - since);
+            }
+        }
+        left = std::max(left, seconds);
+    }
+    double elapsed = std::chrono::duration<double>(now - planStart).count();
+
+    // the bar never goes backwards, even when the estimate grows
+    remaining = (int)(left + 0.5);
+    if (elapsed + left > 0.0)
+        progress = std::max(progress, (int)(PROGRESS_STEPS * elapsed / (elapsed + left)));
+}
+
+
+void AutoCalClient::CheckStarved()
+{
+    struct timeval tv;
+    ::gettimeofday(&tv,0);
+    dsm_time_t now = (dsm_time_t)tv.tv_sec * USECS_PER_SEC + tv.tv_usec;
 
     map<dsm_sample_id_t,struct sA2dSampleInfo>::iterator iSI;
     for ( iSI  = sampleInfo.begin();
@@ -791,29 +1258,52 @@ bool AutoCalClient::Gathered()
         struct sA2dSampleInfo *SI = &(iSI->second);
         if ( SI->isaTemperatureId ) continue;
 
+        const Sequence* seq = lookup(sequences, id(SI->dsmId, SI->devId));
+        if ( seq == 0 || !seq->active || seq->gathered ) continue;
+
+        int VltLvl = seq->level;
+        uint rate = std::max(SI->rate, 1u);
+        dsm_time_t deadline = seq->settleStart +
+          (TDELAY + WATCHDOG_FACTOR * NSAMPS / rate + WATCHDOG_SLACK) * USECS_PER_SEC;
+        if (now < deadline) continue;
+
         map<uint,uint>::iterator iC;
         for ( iC  = SI->channel.begin();
               iC != SI->channel.end(); iC++ )
         {
             uint channel = iC->second;
-            enum fillState fillstate = calActv[VltLvl][SI->dsmId][SI->devId][channel];
+            enum fillState* fillstate = lookup(calActv, VltLvl, SI->dsmId, SI->devId, channel);
+            if ( fillstate == 0 || *fillstate != EMPTY ) continue;
+
+            // give up on this channel at this level, and drop what
+            // little it gathered so the fit does not use it
+            data_d_type& data = calData[SI->dsmId][SI->devId][channel][VltLvl];
+            ostringstream reason;
+            reason << dsmNames[SI->dsmId] << ":" << devNames[id(SI->dsmId, SI->devId)]
+                   << " channel: " << channel << " level: " << VltLvl << "v ";
+            if (data.empty())
+                reason << "received no samples";
+            else
+                reason << "received only " << data.size() << " of " << NSAMPS << " samples";
+            reason << " in " << (now - seq->settleStart) / USECS_PER_SEC
+                   << " seconds at " << SI->rate << " sps";
 
-            if ( fillstate == FULL )
-                isGathered = true;
-            else if ( fillstate == EMPTY )
-                return false;
+            *fillstate = FAILED;
+            data.clear();
+            givenUp.push_back(reason.str());
+
+            std::cout << "watchdog: " << reason.str() << std::endl;
+            errors.post(ERR_WARNING, dsmNames[SI->dsmId], devNames[id(SI->dsmId, SI->devId)],
+                        "gave up on a channel that stopped producing data", reason.str());
         }
     }
-    if (isGathered)
-        std::cout << "AutoCalClient::Gathered" << std::endl;
-
-    return isGathered;
 }
 
 
 void AutoCalClient::DisplayResults()
 {
     std::cout << "AutoCalClient::DisplayResults" << std::endl;
+    Timeline::Span span(timeline, "DisplayResults");
 
 #ifdef SIMULATE
     calData[23][220][3][0].pop_back();
@@ -864,16 +1354,12 @@ void AutoCalClient::DisplayResults()
 
     std::cout << "...................................................................\n";
 
-    struct { int gain; int bplr; } GB[] = {{1,1},{2,0},{2,1},{4,0}};
-
     dsm_d_type::iterator     iiDsm;
     device_d_type::iterator  iiDevice;
-    channel_d_type::iterator iiChannel;
-    level_d_type::iterator   iiLevel;
-    data_d_type::iterator    iiData;
 
-    vector<float> voltageMin;
-    vector<float> voltageMax;
+    // Copy out everything each card needs so that the workers below never
+    // touch (and never insert into) the shared maps.
+    vector<CardJob> jobs;
 
     // for each DSM
     for (iiDsm  = calData.begin();
@@ -886,194 +1372,108 @@ void AutoCalClient::DisplayResults()
         for (iiDevice  = Devices->begin();
              iiDevice != Devices->end(); iiDevice++) {
 
-            QString devErr;
-
-            uint devId               =   iiDevice->first;
-            channel_d_type* Channels = &(iiDevice->second);
-
-            map<uint, double> c0;  // indexed by channel
-            map<uint, double> c1;  // indexed by channel
-
-            // detect bad internal cal voltages on a per board basis
-            map<int, bool> detected;
-
-            // for each channel
-            for (iiChannel  = Channels->begin();
-                 iiChannel != Channels->end(); iiChannel++) {
-
-                uint channel         =   iiChannel->first;
-                level_d_type* Levels = &(iiChannel->second);
-
-                double aVoltageLevel, aVoltageMean, aVoltageWeight;
-                double aVoltageMin, aVoltageMax;
-                vector<double> voltageMean;
-                vector<double> voltageLevel;
-                vector<double> voltageWeight;
-
-                // for each voltage level
-                // NOTE these levels could be from for any (gain, bplr) range.
-                for (iiLevel  = Levels->begin();
-                     iiLevel != Levels->end(); iiLevel++) {
-
-                    int level         =   iiLevel->first;
-                    data_d_type* Data = &(iiLevel->second);
-                    size_t nPts = Data->size();
-                    std::cout << "nPts:   " << nPts << std::endl;
-
-                    // alert user of any out of bound values
-                    for (iiData  = Data->begin(); iiData != Data->end(); iiData++)
-                        if (isnan(*iiData))
-                            if (isNAN[dsmId][devId][channel][level] == false) {
-                                isNAN[dsmId][devId][channel][level] = true;
-
-                                QTextStream cout(stdout, QIODevice::WriteOnly);
-                                QString qstr;
-                                QTextStream(&qstr) << QString::fromStdString(dsmNames[dsmId]) << ":";
-                                QTextStream(&qstr) << QString::fromStdString(devNames[id(dsmId, devId)]);
-                                QTextStream(&qstr) << "\n\nchannel: " << channel << " level: " << level << "v";
-                                QTextStream(&qstr) << " is out of range.\n\nYou may need to adjust ";
-                                QTextStream(&qstr) << "the 2 volt offset potentiometer on this card.\n";
-                                cout << "----------------------------------------------\n";
-                                cout << qstr;
-                                cout << "----------------------------------------------\n";
-                                emit errMessage(qstr);
-                                break;
-                            }
-
-                    // create a vector from the voltage levels
-                    aVoltageLevel = static_cast<double>(level);
-                    voltageLevel.push_back( aVoltageLevel );
-
-                    // create a vector from the computed voltage min
-                    aVoltageMin = gsl_stats_float_min(
-                      &(*Data)[0], 1, nPts);
-                    voltageMin.push_back( aVoltageMin );
-
-                    // create a vector from the computed voltage max
-                    aVoltageMax = gsl_stats_float_max(
-                      &(*Data)[0], 1, nPts);
-                    voltageMax.push_back( aVoltageMax );
-
-                    // create a vector from the computed voltage means
-                    aVoltageMean = gsl_stats_float_mean(
-                      &(*Data)[0], 1, nPts);
-                    voltageMean.push_back( aVoltageMean );
-
-                    // create a vector from the computed voltage weights
-                    aVoltageWeight = gsl_stats_float_variance(
-                      &(*Data)[0], 1, nPts);
-                    aVoltageWeight = (aVoltageWeight == 0.0) ? 1.0 : (1.0 / aVoltageWeight);
-                    voltageWeight.push_back( aVoltageWeight );
-
-                    std::cout << "   aVoltageLevel: "  << setprecision(7) << setw(12) << aVoltageLevel;
-                    std::cout << " | aVoltageMin: "    << setprecision(7) << setw(12) << aVoltageMin;
-                    std::cout << " | aVoltageMax: "    << setprecision(7) << setw(12) << aVoltageMax;
-                    std::cout << " | aVoltageMean: "   << setprecision(7) << setw(12) << aVoltageMean;
-                    std::cout << " | aVoltageWeight: " << setprecision(7) << setw(12) << aVoltageWeight;
-                    std::cout << std::endl;
-                    std::cout << "calData[" << dsmId << "][" << devId << "][" << channel << "][" << level << "]" << std::endl;
-                    for (iiData  = Data->begin(); iiData != Data->end(); iiData++)
-                        std::cout << setprecision(7) << setw(12) << *iiData;
-                    std::cout << std::endl;
-
-                    // detect measured values outside of desired level
-                    if ( (aVoltageMean < (aVoltageLevel - 1.0)) ||
-                         (aVoltageMean > (aVoltageLevel + 1.0)) )  {
-
-                        if (detected[level]) continue;
-                        detected[level] = true;
-
-                        QTextStream cout(stdout, QIODevice::WriteOnly);
-
-                        QTextStream(&devErr) << "defective card?    ";
-                        QTextStream(&devErr) << calFileName[dsmId][devId].c_str();
-                        QTextStream(&devErr) << "\n\nchannel: " << channel << " level: " << level << "v\n";
-                        QTextStream(&devErr) << "Internal uncalibrated voltage measures as "<< aVoltageMean << "v\n";
-                    }
-                }
-                size_t nPts = voltageLevel.size();
-                double cov00, cov01, cov11, chisq;
-
-                vector<double>::iterator iVM = voltageMean.begin();
-                std::cout << "channel: " << channel << std::endl;
-                for ( ; iVM != voltageMean.end(); iVM++ )
-                    std::cout << "iVM: " << *iVM << std::endl;
-                std::cout << "voltageLevel.size(): " << nPts << std::endl;
-
-                // compute weighted linear fit to the data
-                gsl_fit_wlinear (&voltageMean[0], 1,
-                                 &voltageWeight[0], 1,
-                                 &voltageLevel[0], 1,
-                                 nPts,
-                                 &c0[channel], &c1[channel], &cov00, &cov01, &cov11, &chisq);
-
-                // store results for access by the Qt interface.
-                int gain = Gains[dsmId][devId][channel];
-                int bplr = Bplrs[dsmId][devId][channel];
-                resultCals[dsmId][devId][channel][gain][bplr].clear();
-                resultCals[dsmId][devId][channel][gain][bplr].push_back(c0[channel]);
-                resultCals[dsmId][devId][channel][gain][bplr].push_back(c1[channel]);
-            }
-            // compute temperature mean
-            resultTemperature[dsmId][devId] =
-              gsl_stats_float_mean(&(temperatureData[dsmId][devId][0]), 1,
-                                     temperatureData[dsmId][devId].size());
-
-            // record results to the device's CalFile
-            ostringstream ostr;
-            ostr << setprecision(5);
-            ostr << std::endl;
-            ostr << "# auto_cal results..." << std::endl;
-            ostr << "# temperature: " << resultTemperature[dsmId][devId] << std::endl;
-            ostr << "#  Date              Gain  Bipolar";
-            for (uint ix = 0; ix < devNchannels[id(dsmId, devId)]; ix++)
-                ostr << "  CH" << ix << "-off   CH" << ix << "-slope";
-            ostr << std::endl;
+            uint devId = iiDevice->first;
 
-            // for each (gain, bplr) range
-            for (uint iGB=0; iGB<4; iGB++) {
-
-                // find out if a channel was calibrated at this range
-                uint channel = 99;
-                for (uint ix = 0; ix < devNchannels[id(dsmId, devId)]; ix++) {
-                    if ( ( Channels->find(ix) != Channels->end() ) &&
-                         ( Gains[dsmId][devId][ix] == GB[iGB].gain ) &&
-                         ( Bplrs[dsmId][devId][ix] == GB[iGB].bplr ) ) {
-                        channel = ix;
-                        break;
-                    }
+            CardJob job;
+            job.dsmId       = dsmId;
+            job.devId       = devId;
+            job.nChannels   = devNchannels[id(dsmId, devId)];
+            job.dsmName     = dsmNames[dsmId];
+            job.devName     = devNames[id(dsmId, devId)];
+            job.calFileName = calFileName[dsmId][devId];
+            job.Channels    = &(iiDevice->second);
+            job.temperature = &(temperatureData[dsmId][devId]);
+            job.gains       = Gains[dsmId][devId];
+            job.bplrs       = Bplrs[dsmId][devId];
+            job.timeStamp   = timeStamp[dsmId][devId];
+
+            map<uint, map<int, numeric::RobustFilter> >::iterator iF;
+            map<int, numeric::RobustFilter>::iterator iL;
+            for (iF  = outlierFilter[dsmId][devId].begin();
+                 iF != outlierFilter[dsmId][devId].end(); iF++)
+                for (iL = iF->second.begin(); iL != iF->second.end(); iL++)
+                {
+                    if (iL->second.rejected())
+                        job.rejected[iF->first][iL->first] = iL->second.rejected();
+                    if (iL->second.nonFinite())
+                        job.nonFinite[iF->first][iL->first] = iL->second.nonFinite();
                 }
-                // display calibrations that were performed at this range
-                if ( channel != 99 ) {
-                    ostr << n_u::UTime(timeStamp[dsmId][devId][channel]).format(true,"%Y %b %d %H:%M:%S");
-                    ostr << setw(6) << dec << GB[iGB].gain;
-                    ostr << setw(9) << dec << GB[iGB].bplr;
-
-                    for (uint ix = 0; ix < devNchannels[id(dsmId, devId)]; ix++) {
-                        if ( ( Channels->find(ix) != Channels->end() ) &&
-                             ( Gains[dsmId][devId][ix] == GB[iGB].gain ) &&
-                             ( Bplrs[dsmId][devId][ix] == GB[iGB].bplr ) )
-
-                            ostr << "  " << setw(9) << c0[ix]
-                                 << " "  << setw(9) << c1[ix];
-                        else
-                            ostr << "          0         1";
-                    }
-                    ostr << std::endl;
-                }
-            }
-            // TODO provide the user the option to review the results before storing them
-            std::cout << "calFileName[" << dsmId << "][" << devId << "] = ";
-            std::cout << calFileName[dsmId][devId] << std::endl;
 
-            calFileResults[dsmId][devId] = ostr.str();
-            std::cout << calFileResults[dsmId][devId] << std::endl;
+            jobs.push_back(job);
+        }
+    }
+
+    unsigned int nThreads = resultThreads;
+    if (nThreads == 0)
+        nThreads = std::thread::hardware_concurrency();
+    if (nThreads == 0)
+        nThreads = 1;
+    if (nThreads > jobs.size())
+        nThreads = jobs.size();
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    vector<CardResult> results = FitCards(jobs, nThreads);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    runReport.add("fit", "", t0);
 
-            // review the device error results
-            if (devErr.length())
-                emit errMessage(devErr);
+    vector<float> voltageMin;
+    vector<float> voltageMax;
+
+    // merge the results back in card order
+    for (size_t i = 0; i < jobs.size(); i++) {
+
+        uint dsmId = jobs[i].dsmId;
+        uint devId = jobs[i].devId;
+        CardResult& result = results[i];
+
+        std::cout << result.log;
+
+        list<pair<uint, int> >::iterator iNan;
+        for (iNan  = result.nanLevels.begin();
+             iNan != result.nanLevels.end(); iNan++)
+            isNAN[dsmId][devId][iNan->first][iNan->second] = true;
+
+        list<string>::iterator iErr;
+        for (iErr  = result.nanErrs.begin();
+             iErr != result.nanErrs.end(); iErr++)
+            errors.post(ERR_WARNING, dsmNames[dsmId], devNames[id(dsmId, devId)],
+                        "channel out of range", *iErr);
+
+        // store results for access by the Qt interface.
+        map<uint, vector<double> >::iterator iCals;
+        for (iCals  = result.cals.begin();
+             iCals != result.cals.end(); iCals++) {
+            uint channel = iCals->first;
+            int gain = Gains[dsmId][devId][channel];
+            int bplr = Bplrs[dsmId][devId][channel];
+            resultCals[dsmId][devId][channel][gain][bplr] = iCals->second;
         }
+        resultTemperature[dsmId][devId] = result.temperature;
+
+        // TODO provide the user the option to review the results before storing them
+        std::cout << "calFileName[" << dsmId << "][" << devId << "] = ";
+        std::cout << calFileName[dsmId][devId] << std::endl;
+
+        calFileResults[dsmId][devId] = result.calFileResults;
+        std::cout << calFileResults[dsmId][devId] << std::endl;
+
+        voltageMin.insert(voltageMin.end(), result.voltageMin.begin(), result.voltageMin.end());
+        voltageMax.insert(voltageMax.end(), result.voltageMax.begin(), result.voltageMax.end());
+
+        // review the device error results
+        if (result.devErr.length())
+            errors.post(ERR_ERROR, dsmNames[dsmId], devNames[id(dsmId, devId)],
+                        "defective card?", result.devErr);
     }
+    list<string>::iterator iGU;
+    for (iGU = givenUp.begin(); iGU != givenUp.end(); iGU++)
+        std::cout << "gave up on " << *iGU << std::endl;
+
+    std::cout << "AutoCalClient::DisplayResults fit " << jobs.size() << " cards on "
+              << nThreads << " threads in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
+              << " usec" << std::endl;
+
     // show totals for Min and Max
     std::cout << "voltageMin.size() = " << voltageMin.size() << std::endl;
     std::cout << "voltageMax.size() = " << voltageMax.size() << std::endl;
@@ -1084,10 +1484,609 @@ void AutoCalClient::DisplayResults()
     std::cout << "allVoltageMin = " << allVoltageMin << std::endl;
     std::cout << "allVoltageMax = " << allVoltageMax << std::endl;
 
+    BuildResultViews();
+
     progress = maxProgress();
 }
 
 
+// Compute the fits and CalFile text for one card.  This runs on a worker
+// thread, so it may only use what was copied into the job; log output is
+// collected and printed by the caller in card order.
+//
+vector<AutoCalClient::CardResult> AutoCalClient::FitCards(const vector<CardJob>& jobs,
+                                                          unsigned int nThreads)
+{
+    // Reduce the cards on a small pool of threads.  Each worker pulls the
+    // next card index, so results land in card order regardless of which
+    // thread finished first.
+    vector<CardResult> results(jobs.size());
+
+    std::atomic<size_t> next(0);
+    vector<std::thread> workers;
+    for (unsigned int t = 0; t < nThreads; t++)
+        workers.push_back(std::thread([this, &jobs, &results, &next]() {
+            timeline.nameThread("fit");
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                string card = jobs[i].dsmName + ":" + jobs[i].devName;
+                RunReport::Timer timer(runReport, "fit card", card);
+                Timeline::Span span(timeline, "ComputeCardResults", card);
+                results[i] = ComputeCardResults(jobs[i]);
+            }
+        }));
+    for (unsigned int t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    return results;
+}
+
+
+string AutoCalClient::BenchmarkFit(unsigned int nCards, unsigned int maxThreads)
+{
+    static const int levels[] = { 0, 1, 5, 10, -10 };
+    const uint nChannels = 8;
+
+    // a synthetic fleet: every channel 1T, a little off true, with noise
+    vector<channel_d_type> channels(nCards);
+    vector<data_d_type> temperatures(nCards);
+    vector<CardJob> jobs(nCards);
+    unsigned int seed = 1;
+    for (unsigned int card = 0; card < nCards; card++) {
+        CardJob& job = jobs[card];
+        job.dsmId = 1 + card / 4;
+        job.devId = 200 + card % 4;
+        job.nChannels = nChannels;
+        ostringstream dsm, dev;
+        dsm << "dsm" << job.dsmId;
+        dev << "a2d" << job.devId;
+        job.dsmName = dsm.str();
+        job.devName = dev.str();
+        job.calFileName = job.devName + ".dat";
+
+        for (uint chn = 0; chn < nChannels; chn++) {
+            job.gains[chn] = 1;
+            job.bplrs[chn] = 1;
+            job.timeStamp[chn] = 0;
+            for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+                data_d_type& data = channels[card][chn][levels[l]];
+                for (int i = 0; i < NSAMPS; i++) {
+                    seed = seed * 1103515245 + 12345;
+                    float noise = ((seed >> 16) % 1000 - 500) * 1.0e-6;
+                    data.push_back(levels[l] * 0.998 + 0.003 * chn + noise);
+                }
+            }
+        }
+        temperatures[card].assign(NSAMPS, 25.0);
+        job.Channels = &channels[card];
+        job.temperature = &temperatures[card];
+    }
+
+    if (maxThreads == 0)
+        maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = 1;
+
+    // best of a few passes, to take out thread start up and cache effects
+    const int passes = 5;
+    ostringstream ostr;
+    ostr << "fit " << nCards << " synthetic cards (" << nChannels << " channels, "
+         << sizeof(levels) / sizeof(levels[0]) << " levels, " << NSAMPS << " samples)\n"
+         << "threads   best ms   speedup\n";
+    double single = 0.0;
+    for (unsigned int nThreads = 1; nThreads <= maxThreads; nThreads++) {
+        double best = 0.0;
+        for (int pass = 0; pass < passes; pass++) {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            vector<CardResult> results = FitCards(jobs, nThreads);
+            double ms = std::chrono::duration<double, std::milli>
+                          (std::chrono::steady_clock::now() - t0).count();
+            if (pass == 0 || ms < best)
+                best = ms;
+        }
+        if (nThreads == 1)
+            single = best;
+        ostr << setw(7) << nThreads << fixed << setprecision(2) << setw(10) << best
+             << setw(10) << (best > 0.0 ? single / best : 0.0) << "\n";
+    }
+    return ostr.str();
+}
+
+
+AutoCalClient::CardResult AutoCalClient::ComputeCardResults(const CardJob& job)
+{
+    CardResult result;
+    ostringstream log;
+    ostringstream outliers;
+
+    struct { int gain; int bplr; } GB[] = {{1,1},{2,0},{2,1},{4,0}};
+
+    uint dsmId = job.dsmId;
+    uint devId = job.devId;
+    const channel_d_type* Channels = job.Channels;
+
+    channel_d_type::const_iterator iiChannel;
+    level_d_type::const_iterator   iiLevel;
+    data_d_type::const_iterator    iiData;
+
+    map<uint, double> c0;  // indexed by channel
+    map<uint, double> c1;  // indexed by channel
+
+    // detect bad internal cal voltages on a per board basis
+    map<int, bool> detected;
+
+    // for each channel
+    for (iiChannel  = Channels->begin();
+         iiChannel != Channels->end(); iiChannel++) {
+
+        uint channel               =   iiChannel->first;
+        const level_d_type* Levels = &(iiChannel->second);
+
+        double aVoltageLevel, aVoltageMean, aVoltageWeight;
+        double aVoltageMin, aVoltageMax;
+        vector<double> voltageMean;
+        vector<double> voltageLevel;
+        vector<double> voltageWeight;
+
+        // for each voltage level
+        // NOTE these levels could be from for any (gain, bplr) range.
+        for (iiLevel  = Levels->begin();
+             iiLevel != Levels->end(); iiLevel++) {
+
+            int level               =   iiLevel->first;
+            const data_d_type* Data = &(iiLevel->second);
+            size_t nPts = Data->size();
+            log << "nPts:   " << nPts << std::endl;
+
+            // NaNs were kept out of Data; mostly NaNs means out of range
+            uint nNan = 0;
+            map<uint, map<int, uint> >::const_iterator iN = job.nonFinite.find(channel);
+            if (iN != job.nonFinite.end() && iN->second.count(level))
+                nNan = iN->second.at(level);
+            if (nNan)
+                log << "channel: " << channel << " level: " << level << "v dropped "
+                    << nNan << " NaN samples" << std::endl;
+
+            bool outOfRange = nNan > nPts;
+            for (iiData  = Data->begin(); iiData != Data->end() && !outOfRange; iiData++)
+                outOfRange = isnan(*iiData);
+
+            // alert user of any out of bound values
+            if (outOfRange) {
+                result.nanLevels.push_back(make_pair(channel, level));
+
+                ostringstream nanErr;
+                nanErr << job.dsmName << ":" << job.devName;
+                nanErr << "\n\nchannel: " << channel << " level: " << level << "v";
+                nanErr << " is out of range.\n\nYou may need to adjust ";
+                nanErr << "the 2 volt offset potentiometer on this card.\n";
+                log << "----------------------------------------------\n";
+                log << nanErr.str();
+                log << "----------------------------------------------\n";
+                result.nanErrs.push_back(nanErr.str());
+            }
+
+            // nothing gathered here, e.g. the watchdog gave up on it
+            if (nPts == 0) continue;
+
+            map<uint, map<int, uint> >::const_iterator iR = job.rejected.find(channel);
+            if (iR != job.rejected.end() && iR->second.count(level)) {
+                uint nRejected = iR->second.at(level);
+                log << "channel: " << channel << " level: " << level << "v rejected "
+                    << nRejected << " outlier samples" << std::endl;
+                outliers << "# CH" << channel << " " << level << "v: rejected "
+                         << nRejected << " outlier samples" << std::endl;
+            }
+
+            // create a vector from the voltage levels
+            aVoltageLevel = static_cast<double>(level);
+            voltageLevel.push_back( aVoltageLevel );
+
+            // create a vector from the computed voltage min
+            aVoltageMin = gsl_stats_float_min(
+              &(*Data)[0], 1, nPts);
+            result.voltageMin.push_back( aVoltageMin );
+
+            // create a vector from the computed voltage max
+            aVoltageMax = gsl_stats_float_max(
+              &(*Data)[0], 1, nPts);
+            result.voltageMax.push_back( aVoltageMax );
+
+            // create a vector from the computed voltage means
+            aVoltageMean = gsl_stats_float_mean(
+              &(*Data)[0], 1, nPts);
+            voltageMean.push_back( aVoltageMean );
+
+            // create a vector from the computed voltage weights
+            aVoltageWeight = gsl_stats_float_variance(
+              &(*Data)[0], 1, nPts);
+            aVoltageWeight = (aVoltageWeight == 0.0) ? 1.0 : (1.0 / aVoltageWeight);
+            voltageWeight.push_back( aVoltageWeight );
+
+            log << "   aVoltageLevel: "  << setprecision(7) << setw(12) << aVoltageLevel;
+            log << " | aVoltageMin: "    << setprecision(7) << setw(12) << aVoltageMin;
+            log << " | aVoltageMax: "    << setprecision(7) << setw(12) << aVoltageMax;
+            log << " | aVoltageMean: "   << setprecision(7) << setw(12) << aVoltageMean;
+            log << " | aVoltageWeight: " << setprecision(7) << setw(12) << aVoltageWeight;
+            log << std::endl;
+            log << "calData[" << dsmId << "][" << devId << "][" << channel << "][" << level << "]" << std::endl;
+            for (iiData  = Data->begin(); iiData != Data->end(); iiData++)
+                log << setprecision(7) << setw(12) << *iiData;
+            log << std::endl;
+
+            // detect measured values outside of desired level
+            if ( (aVoltageMean < (aVoltageLevel - 1.0)) ||
+                 (aVoltageMean > (aVoltageLevel + 1.0)) )  {
+
+                if (detected[level]) continue;
+                detected[level] = true;
+
+                ostringstream devErr;
+                devErr << "defective card?    ";
+                devErr << job.calFileName;
+                devErr << "\n\nchannel: " << channel << " level: " << level << "v\n";
+                devErr << "Internal uncalibrated voltage measures as "<< aVoltageMean << "v\n";
+                result.devErr += devErr.str();
+            }
+        }
+        size_t nPts = voltageLevel.size();
+        double cov00, cov01, cov11, chisq;
+
+        vector<double>::iterator iVM = voltageMean.begin();
+        log << "channel: " << channel << std::endl;
+        for ( ; iVM != voltageMean.end(); iVM++ )
+            log << "iVM: " << *iVM << std::endl;
+        log << "voltageLevel.size(): " << nPts << std::endl;
+
+        if (nPts < 2) {
+            log << "channel: " << channel << " has too few levels to fit" << std::endl;
+            continue;
+        }
+
+        // compute weighted linear fit to the data
+        gsl_fit_wlinear (&voltageMean[0], 1,
+                         &voltageWeight[0], 1,
+                         &voltageLevel[0], 1,
+                         nPts,
+                         &c0[channel], &c1[channel], &cov00, &cov01, &cov11, &chisq);
+
+        result.cals[channel].push_back(c0[channel]);
+        result.cals[channel].push_back(c1[channel]);
+    }
+    // compute temperature mean
+    result.temperature =
+      gsl_stats_float_mean(&((*job.temperature)[0]), 1,
+                             job.temperature->size());
+
+    // record results to the device's CalFile
+    ostringstream ostr;
+    ostr << setprecision(5);
+    ostr << std::endl;
+    ostr << "# auto_cal results..." << std::endl;
+    ostr << "# temperature: " << result.temperature << std::endl;
+    ostr << outliers.str();
+    ostr << "#  Date              Gain  Bipolar";
+    for (uint ix = 0; ix < job.nChannels; ix++)
+        ostr << "  CH" << ix << "-off   CH" << ix << "-slope";
+    ostr << std::endl;
+
+    // for each (gain, bplr) range
+    for (uint iGB=0; iGB<4; iGB++) {
+
+        // find out if a channel was calibrated at this range
+        uint channel = 99;
+        for (uint ix = 0; ix < job.nChannels; ix++) {
+            if ( ( result.cals.find(ix) != result.cals.end() ) &&
+                 ( job.gains.at(ix) == GB[iGB].gain ) &&
+                 ( job.bplrs.at(ix) == GB[iGB].bplr ) ) {
+                channel = ix;
+                break;
+            }
+        }
+        // display calibrations that were performed at this range
+        if ( channel != 99 ) {
+            ostr << n_u::UTime(job.timeStamp.at(channel)).format(true,"%Y %b %d %H:%M:%S");
+            ostr << setw(6) << dec << GB[iGB].gain;
+            ostr << setw(9) << dec << GB[iGB].bplr;
+
+            for (uint ix = 0; ix < job.nChannels; ix++) {
+                if ( ( result.cals.find(ix) != result.cals.end() ) &&
+                     ( job.gains.at(ix) == GB[iGB].gain ) &&
+                     ( job.bplrs.at(ix) == GB[iGB].bplr ) )
+
+                    ostr << "  " << setw(9) << c0[ix]
+                         << " "  << setw(9) << c1[ix];
+                else
+                    ostr << "          0         1";
+            }
+            ostr << std::endl;
+        }
+    }
+    result.calFileResults = ostr.str();
+    result.log = log.str();
+
+    return result;
+}
+
+
+// Checkpoint layout, native byte order:
+//   "ACK3"  uint nSequences
+//   per card:    uint dsmId  uint devId  uint nDone  int level[nDone]
+//   uint nCards
+//   per card:    uint dsmId  uint devId  uint nTemp  float temperature[nTemp]
+//                uint nRecords
+//   per record:  uint chn  int gain  int bplr  int level  dsm_time_t timeStamp
+//                uint n  float data[n]
+//
+template <typename T>
+static void put(ofstream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool get(ifstream& in, T& value)
+{
+    return in.read(reinterpret_cast<char*>(&value), sizeof(T)).good();
+}
+
+
+void AutoCalClient::SaveCheckpoint()
+{
+    if (checkpointFile.empty()) return;
+
+    string tmpFile = checkpointFile + ".tmp";
+    ofstream out(tmpFile.c_str(), ios::binary | ios::trunc);
+    if (!out) {
+        std::cout << "failed to write checkpoint: " << tmpFile << std::endl;
+        return;
+    }
+    out.write(checkpointMagic, sizeof(checkpointMagic));
+
+    // Only the levels each card has finished are saved; a level still
+    // being gathered is gathered again on resume.
+    map<dsm_sample_id_t, set<int> > doneLevels;        // indexed by id(dsmId, devId)
+    uint nSaved = 0;
+
+    put(out, (uint) sequences.size());
+    map<dsm_sample_id_t, Sequence>::iterator iSeq;
+    for (iSeq = sequences.begin(); iSeq != sequences.end(); iSeq++) {
+        Sequence& seq = iSeq->second;
+
+        uint nDone = seq.next;
+        if (seq.active && !seq.gathered)
+            nDone--;
+
+        put(out, seq.dsmId);
+        put(out, seq.devId);
+        put(out, nDone);
+        for (uint i = 0; i < nDone; i++) {
+            put(out, seq.levels[i]);
+            doneLevels[iSeq->first].insert(seq.levels[i]);
+        }
+        nSaved += nDone;
+    }
+    streampos nCardsPos = out.tellp();
+    put(out, (uint) 0);    // nCards, filled in below
+
+    uint nCards = 0;
+    dsm_d_type::iterator     iiDsm;
+    device_d_type::iterator  iiDevice;
+    channel_d_type::iterator iiChannel;
+    level_d_type::iterator   iiLevel;
+
+    for (iiDsm = calData.begin(); iiDsm != calData.end(); iiDsm++) {
+        uint dsmId = iiDsm->first;
+
+        for (iiDevice  = iiDsm->second.begin();
+             iiDevice != iiDsm->second.end(); iiDevice++) {
+            uint devId = iiDevice->first;
+            const set<int>& done = doneLevels[id(dsmId, devId)];
+            nCards++;
+
+            data_d_type& temperature = temperatureData[dsmId][devId];
+            put(out, dsmId);
+            put(out, devId);
+            put(out, (uint) temperature.size());
+            out.write(reinterpret_cast<const char*>(temperature.data()),
+                      temperature.size() * sizeof(float));
+
+            uint nRecords = 0;
+            for (iiChannel  = iiDevice->second.begin();
+                 iiChannel != iiDevice->second.end(); iiChannel++)
+                for (iiLevel  = iiChannel->second.begin();
+                     iiLevel != iiChannel->second.end(); iiLevel++)
+                    if (!iiLevel->second.empty() && done.count(iiLevel->first))
+                        nRecords++;
+            put(out, nRecords);
+
+            for (iiChannel  = iiDevice->second.begin();
+                 iiChannel != iiDevice->second.end(); iiChannel++) {
+                uint channel = iiChannel->first;
+
+                for (iiLevel  = iiChannel->second.begin();
+                     iiLevel != iiChannel->second.end(); iiLevel++) {
+                    data_d_type& data = iiLevel->second;
+                    if (data.empty() || !done.count(iiLevel->first)) continue;
+
+                    put(out, channel);
+                    put(out, Gains[dsmId][devId][channel]);
+                    put(out, Bplrs[dsmId][devId][channel]);
+                    put(out, iiLevel->first);
+                    put(out, timeStamp[dsmId][devId][channel]);
+                    put(out, (uint) data.size());
+                    out.write(reinterpret_cast<const char*>(data.data()),
+                              data.size() * sizeof(float));
+                }
+            }
+        }
+    }
+    // now that the cards are counted, fill in the header
+    out.seekp(nCardsPos);
+    put(out, nCards);
+    out.close();
+
+    if (!out || ::rename(tmpFile.c_str(), checkpointFile.c_str())) {
+        std::cout << "failed to write checkpoint: " << checkpointFile << std::endl;
+        return;
+    }
+    std::cout << "checkpoint: " << nSaved << " card levels saved to "
+              << checkpointFile << std::endl;
+}
+
+
+bool AutoCalClient::LoadCheckpoint()
+{
+    ifstream in(checkpointFile.c_str(), ios::binary);
+    if (!in) {
+        std::cout << "no checkpoint to resume from: " << checkpointFile << std::endl;
+        return true;
+    }
+    char magic[sizeof(checkpointMagic)];
+    uint nSequences, nCards;
+    if (!in.read(magic, sizeof(magic)) ||
+        memcmp(magic, checkpointMagic, sizeof(magic)) ||
+        !get(in, nSequences)) {
+        std::cout << "not a checkpoint file: " << checkpointFile << std::endl;
+        return true;
+    }
+
+    // Everything is read into these first, and only restored once the
+    // whole file has been read: a truncated or corrupt checkpoint
+    // restores nothing.  Every count is bounded before anything is sized
+    // by it.
+    struct Record {
+        uint dsmId, devId, channel;
+        int level;
+        dsm_time_t t;
+        data_d_type data;
+    };
+    map<uint, map<uint, data_d_type> > temperatures;
+    list<Record> records;
+
+    // A card resumes only if the levels it finished are still the first
+    // levels of its sequence in this run; otherwise it starts over.
+    map<dsm_sample_id_t, set<int> > doneLevels;        // indexed by id(dsmId, devId)
+    map<dsm_sample_id_t, uint> nDone;                  // indexed by id(dsmId, devId)
+    bool corrupt = false;
+    for (uint iSeq = 0; iSeq < nSequences && !corrupt; iSeq++) {
+        uint dsmId, devId, n;
+        if (!get(in, dsmId) || !get(in, devId) || !get(in, n) ||
+            n > plans.selectable().size()) {
+            corrupt = true;
+            break;
+        }
+        vector<int> levels(n);
+        for (uint i = 0; i < n && !corrupt; i++)
+            corrupt = !get(in, levels[i]);
+        if (corrupt) break;
+
+        const Sequence* seq = lookup(sequences, id(dsmId, devId));
+        if (seq == 0 || n > seq->levels.size() ||
+            !std::equal(levels.begin(), levels.end(), seq->levels.begin())) {
+            std::cout << "checkpoint card " << dsmId << ":" << devId
+                      << " levels do not match this run, ignoring it" << std::endl;
+            continue;
+        }
+        nDone[id(dsmId, devId)] = n;
+        doneLevels[id(dsmId, devId)].insert(levels.begin(), levels.end());
+    }
+    if (!corrupt)
+        corrupt = !get(in, nCards);
+
+    for (uint iCard = 0; iCard < nCards && !corrupt; iCard++) {
+        uint dsmId, devId, nTemp, nRecords;
+        if (!get(in, dsmId) || !get(in, devId) || !get(in, nTemp) || nTemp > NSAMPS) {
+            corrupt = true;
+            break;
+        }
+        data_d_type temperature(nTemp);
+        in.read(reinterpret_cast<char*>(temperature.data()), nTemp * sizeof(float));
+        if (!get(in, nRecords)) {
+            corrupt = true;
+            break;
+        }
+
+        // only restore cards that Setup() accepted in this run
+        bool known = lookup(VarNames, dsmId, devId) != 0 && nDone.count(id(dsmId, devId));
+        if (known)
+            temperatures[dsmId][devId] = temperature;
+        else
+            std::cout << "checkpoint card " << dsmId << ":" << devId
+                      << " is not in this run, ignoring it" << std::endl;
+
+        for (uint iRec = 0; iRec < nRecords; iRec++) {
+            Record rec;
+            uint n;
+            int gain, bplr;
+            rec.dsmId = dsmId;
+            rec.devId = devId;
+            if (!get(in, rec.channel) || !get(in, gain) || !get(in, bplr) ||
+                !get(in, rec.level) || !get(in, rec.t) || !get(in, n) || n > NSAMPS) {
+                corrupt = true;
+                break;
+            }
+            rec.data.resize(n);
+            in.read(reinterpret_cast<char*>(rec.data.data()), n * sizeof(float));
+            if (!in) {
+                corrupt = true;
+                break;
+            }
+            if (!known || !doneLevels[id(dsmId, devId)].count(rec.level)) continue;
+
+            // the card must still be set up the way it was when gathered
+            const int* g = lookup(Gains, dsmId, devId, rec.channel);
+            const int* b = lookup(Bplrs, dsmId, devId, rec.channel);
+            const enum fillState* fill = lookup(calActv, rec.level, dsmId, devId, rec.channel);
+            if (g == 0 || b == 0 || fill == 0 || *g != gain || *b != bplr) {
+                std::cout << "checkpoint channel " << dsmId << ":" << devId << ":" << rec.channel
+                          << " changed setup, ignoring its " << rec.level << "v data" << std::endl;
+                continue;
+            }
+            records.push_back(rec);
+        }
+    }
+    if (corrupt) {
+        std::cout << "checkpoint is truncated or corrupt, restoring nothing from it: "
+                  << checkpointFile << std::endl;
+        return true;
+    }
+
+    // the whole file is good; restore it
+    map<uint, map<uint, data_d_type> >::iterator iT;
+    map<uint, data_d_type>::iterator iD;
+    for (iT = temperatures.begin(); iT != temperatures.end(); iT++)
+        for (iD = iT->second.begin(); iD != iT->second.end(); iD++)
+            temperatureData[iT->first][iD->first] = iD->second;
+
+    list<Record>::iterator iR;
+    for (iR = records.begin(); iR != records.end(); iR++) {
+        calData[iR->dsmId][iR->devId][iR->channel][iR->level] = iR->data;
+        timeStamp[iR->dsmId][iR->devId][iR->channel] = iR->t;
+        if (iR->data.size() >= NSAMPS)
+            *lookup(calActv, iR->level, iR->dsmId, iR->devId, iR->channel) = FULL;
+    }
+
+    // each card continues with the level after the last one it completed
+    map<dsm_sample_id_t, uint>::iterator iDone;
+    for (iDone = nDone.begin(); iDone != nDone.end(); iDone++) {
+        Sequence& seq = sequences[iDone->first];
+        seq.next = iDone->second;
+        std::cout << "resuming " << dsmNames[seq.dsmId] << ":" << devNames[iDone->first]
+                  << " after " << iDone->second << " levels" << std::endl;
+    }
+    UpdateProgress();
+
+    return false;
+}
+
+
+void AutoCalClient::RemoveCheckpoint()
+{
+    if (!checkpointFile.empty())
+        ::unlink(checkpointFile.c_str());
+}
+
+
 void AutoCalClient::SaveAllCalFiles()
 {
     dsm_d_type::iterator     iiDsm;
@@ -1109,11 +2108,38 @@ void AutoCalClient::SaveAllCalFiles()
             SaveCalFile(dsmId, devId);
         }
     }
+    // now with the save times
+    SaveRunReport();
+}
+
+
+void AutoCalClient::SaveRunReport()
+{
+    // beside the results that SaveCalFile() writes
+    set<string> dirs;
+    map<uint, map<uint, string> >::iterator iD;
+    map<uint, string>::iterator iP;
+    for (iD = calFilePath.begin(); iD != calFilePath.end(); iD++)
+        for (iP = iD->second.begin(); iP != iD->second.end(); iP++) {
+            string dir = iP->second + '/';
+            size_t pos = dir.find("/A2D/");
+            if (pos == string::npos)
+                continue;
+            dir.replace(pos, 5, "/auto_cal/");
+            dirs.insert(dir.substr(0, dir.length() - 1));
+        }
+
+    runReport.setCards(sequences.size());
+    if (!runReport.save(dirs))
+        errors.post(ERR_WARNING, "", "", "run report not saved",
+                    "could not write the run report beside the auto_cal results");
 }
 
 
 void AutoCalClient::SaveCalFile(uint dsmId, uint devId)
 {
+    RunReport::Timer timer(runReport, "save", dsmNames[dsmId] + ":" + devNames[id(dsmId, devId)]);
+
     size_t pos;
     ostringstream ostr;
     string aCalFile = calFilePath[dsmId][devId] + '/' +
@@ -1123,7 +2149,8 @@ void AutoCalClient::SaveCalFile(uint dsmId, uint devId)
     // directory.  Bail if we don't understand save path.
     if ((pos = aCalFile.find("/A2D/")) == string::npos) {
         ostr << "Will not save to " << aCalFile;
-        QMessageBox::warning(0, "error", ostr.str().c_str());
+        errors.post(ERR_ERROR, dsmNames[dsmId], devNames[id(dsmId, devId)],
+                    "results not saved", ostr.str());
         return;
     }
 
@@ -1131,8 +2158,8 @@ void AutoCalClient::SaveCalFile(uint dsmId, uint devId)
 
     if (calFileSaved[dsmId][devId]) {
         ostr << "results already saved to: " << aCalFile;
-        std::cout << ostr.str() << std::endl;
-        QMessageBox::information(0, "notice", ostr.str().c_str());
+        errors.post(ERR_INFO, dsmNames[dsmId], devNames[id(dsmId, devId)],
+                    "results already saved", ostr.str());
         return;
     }
 
@@ -1144,8 +2171,8 @@ void AutoCalClient::SaveCalFile(uint dsmId, uint devId)
     if (fd == -1) {
         ostr << "failed to save results to: " << aCalFile << std::endl;
         ostr << strerror(errno);
-        std::cout << ostr.str() << std::endl;
-        QMessageBox::warning(0, "error", ostr.str().c_str());
+        errors.post(ERR_ERROR, dsmNames[dsmId], devNames[id(dsmId, devId)],
+                    "results not saved", ostr.str());
         return;
     }
     write(fd, calFileResults[dsmId][devId].c_str(),
@@ -1161,38 +2188,29 @@ void AutoCalClient::SaveCalFile(uint dsmId, uint devId)
 }
 
 
-list<int> AutoCalClient::GetVoltageLevels()
+const VoltagePlans::Plan& AutoCalClient::GetVoltageLevels() const
 {
-    return voltageLevels["XX"];
+    return plans.selectable();
 }
 
 
-list<int> AutoCalClient::GetVoltageLevels(uint dsmId, uint devId, uint chn)
+const VoltagePlans::Plan& AutoCalClient::GetVoltageLevels(uint dsmId, uint devId, uint chn) const
 {
-    if ( VarNames[dsmId][devId][chn] == "" )
-        return voltageLevels["--"];
-
-    int gain = Gains[dsmId][devId][chn];
-    int bplr = Bplrs[dsmId][devId][chn];
-
-    ostringstream gb;
-    if (cardType[id(dsmId, devId)] == "gpDAQ" ||
-        cardType[id(dsmId, devId)] == "dmmat")
-        gb << cardType[id(dsmId, devId)];
-    else
-        gb << gain << (bplr ? "T" : "F");
+    if ( GetVarName(dsmId, devId, chn) == noVarName )
+        return plans.get(PLAN_NONE);
 
-    return voltageLevels[gb.str()];
+    const int* code = lookup(PlanCodes, dsmId, devId, chn);
+    return plans.get(code ? *code : PLAN_NONE);
 }
 
 
-string AutoCalClient::GetVarName(uint dsmId, uint devId, uint chn)
+const string& AutoCalClient::GetVarName(uint dsmId, uint devId, uint chn) const
 {
-    if ( VarNames[dsmId][devId][chn] == "" )
-        return "---";
+    const string* name = lookup(VarNames, dsmId, devId, chn);
+    if ( name == 0 || name->empty() )
+        return noVarName;
 
-    QStrBuf.str(""); QStrBuf << VarNames[dsmId][devId][chn];
-    return QStrBuf.str();
+    return *name;
 }
 
 float AutoCalClient::GetVoltageData(uint dsmId, uint devId, uint chn)
@@ -1211,58 +2229,123 @@ float AutoCalClient::GetVoltageData(uint dsmId, uint devId, uint chn)
     return voltage;
 }
 
-string AutoCalClient::GetOldTimeStamp(uint dsmId, uint devId, uint chn)
+string AutoCalClient::GetOldTimeStamp(uint dsmId, uint devId, uint chn) const
 {
-    int gain = Gains[dsmId][devId][chn];
-    int bplr = Bplrs[dsmId][devId][chn];
+    const int* gain = lookup(Gains, dsmId, devId, chn);
+    const int* bplr = lookup(Bplrs, dsmId, devId, chn);
+    if (gain == 0 || bplr == 0)
+        return noTimeStamp;
 
-    if (calFileTime[dsmId][devId][gain][bplr] == 0)
-        return "---- --- -- --:--:--";
+    const dsm_time_t* t = lookup(calFileTime, dsmId, devId, *gain, *bplr);
+    if (t == 0 || *t == 0)
+        return noTimeStamp;
 
-    return n_u::UTime(calFileTime[dsmId][devId][gain][bplr]).format(true,"%Y %b %d %H:%M:%S");
+    return n_u::UTime(*t).format(true,"%Y %b %d %H:%M:%S");
 }
 
 
-string AutoCalClient::GetNewTimeStamp(uint dsmId, uint devId, uint chn)
+string AutoCalClient::GetNewTimeStamp(uint dsmId, uint devId, uint chn) const
 {
-    if (timeStamp[dsmId][devId][chn] == 0)
-        return "---- --- -- --:--:--";
+    const dsm_time_t* t = lookup(timeStamp, dsmId, devId, chn);
+    if (t == 0 || *t == 0)
+        return noTimeStamp;
 
-    return n_u::UTime(timeStamp[dsmId][devId][chn]).format(true,"%Y %b %d %H:%M:%S");
+    return n_u::UTime(*t).format(true,"%Y %b %d %H:%M:%S");
 }
 
 
-float AutoCalClient::GetOldTemperature(uint dsmId, uint devId, uint chn)
+float AutoCalClient::GetOldTemperature(uint dsmId, uint devId, uint chn) const
 {
     return floatNAN;
 }
 
 
-float AutoCalClient::GetNewTemperature(uint dsmId, uint devId, uint chn)
+float AutoCalClient::GetNewTemperature(uint dsmId, uint devId, uint chn) const
 {
-    return resultTemperature[dsmId][devId];
+    const float* t = lookup(resultTemperature, dsmId, devId);
+    return t ? *t : 0.0;
 }
 
 
-vector<double> AutoCalClient::GetOldCals(uint dsmId, uint devId, uint chn)
+const vector<double>& AutoCalClient::GetOldCals(uint dsmId, uint devId, uint chn) const
 {
-    int gain = Gains[dsmId][devId][chn];
-    int bplr = Bplrs[dsmId][devId][chn];
+    const int* gain = lookup(Gains, dsmId, devId, chn);
+    const int* bplr = lookup(Bplrs, dsmId, devId, chn);
+    if (gain == 0 || bplr == 0)
+        return noCals;
+
+    const vector<double>* cals = lookup(calFileCals, dsmId, devId, chn, *gain, *bplr);
+    return cals ? *cals : noCals;
+}
+
+
+const vector<double>& AutoCalClient::GetNewCals(uint dsmId, uint devId, uint chn) const
+{
+    const int* gain = lookup(Gains, dsmId, devId, chn);
+    const int* bplr = lookup(Bplrs, dsmId, devId, chn);
+    if (gain == 0 || bplr == 0)
+        return noCals;
+
+    const vector<double>* cals = lookup(resultCals, dsmId, devId, chn, *gain, *bplr);
+    return cals ? *cals : noCals;
+}
 
-    return calFileCals[dsmId][devId][chn][gain][bplr];
+
+void AutoCalClient::BuildResultViews()
+{
+    std::shared_ptr<view_map_type> views(new view_map_type);
+
+    map<uint, map<uint, map<uint, string> > >::const_iterator iDsm;
+    map<uint, map<uint, string> >::const_iterator iDev;
+
+    // for each configured card
+    for (iDsm = VarNames.begin(); iDsm != VarNames.end(); iDsm++) {
+        uint dsmId = iDsm->first;
+
+        for (iDev = iDsm->second.begin(); iDev != iDsm->second.end(); iDev++) {
+            uint devId = iDev->first;
+
+            vector<ChannelView>& card = (*views)[id(dsmId, devId)];
+            card.resize(MAX_A2D_CHANNELS);
+
+            for (uint chn = 0; chn < MAX_A2D_CHANNELS; chn++) {
+                ChannelView& view = card[chn];
+
+                view.varName        = QString::fromStdString(GetVarName(dsmId, devId, chn));
+                view.oldTimeStamp   = QString::fromStdString(GetOldTimeStamp(dsmId, devId, chn));
+                view.newTimeStamp   = QString::fromStdString(GetNewTimeStamp(dsmId, devId, chn));
+                view.oldTemperature = QString::number(GetOldTemperature(dsmId, devId, chn));
+                view.newTemperature = QString::number(GetNewTemperature(dsmId, devId, chn));
+
+                const vector<double>& oldCals = GetOldCals(dsmId, devId, chn);
+                if (oldCals.size() > 1) {
+                    view.oldIntcp = QString::number(oldCals[0]);
+                    view.oldSlope = QString::number(oldCals[1]);
+                }
+                const vector<double>& newCals = GetNewCals(dsmId, devId, chn);
+                if (newCals.size() > 1) {
+                    view.newIntcp = QString::number(newCals[0]);
+                    view.newSlope = QString::number(newCals[1]);
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(viewMutex);
+    resultViews = views;
 }
 
 
-vector<double> AutoCalClient::GetNewCals(uint dsmId, uint devId, uint chn)
+std::shared_ptr<const AutoCalClient::view_map_type> AutoCalClient::GetResultViews() const
 {
-    int gain = Gains[dsmId][devId][chn];
-    int bplr = Bplrs[dsmId][devId][chn];
+    std::lock_guard<std::mutex> lock(viewMutex);
+    if (!resultViews)
+        return std::shared_ptr<const view_map_type>(new view_map_type);
 
-    return resultCals[dsmId][devId][chn][gain][bplr];
+    return resultViews;
 }
 
 
-dsm_sample_id_t AutoCalClient::id(unsigned int dsmId, unsigned int devId)
+dsm_sample_id_t AutoCalClient::id(unsigned int dsmId, unsigned int devId) const
 {
     dsm_sample_id_t id = 0;
     id = SET_DSM_ID(id, dsmId);
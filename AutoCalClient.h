@@ -31,13 +31,30 @@
 
 #include <map>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <vector>
 #include <string>
 
 #include <QObject>
+#include <QString>
+
+#include "ChannelMetrics.h"
+#include "ClockOffsets.h"
+#include "ErrorLog.h"
+#include "LevelScheduler.h"
+#include "RobustFilter.h"
+#include "RunPlanner.h"
+#include "RunReport.h"
+#include "Timeline.h"
+#include "VoltagePlans.h"
+#include "XmlRpcControl.h"
 
 #define MAX_A2D_CHANNELS         32       // Number of A/D's per card
 #define NSAMPS 100
+#define PROGRESS_STEPS 1000     // progress counts planned time in these
 //#define SIMULATE
 
 using namespace nidas::core;
@@ -45,7 +62,9 @@ using namespace std;
 
 enum stateEnum { GATHER, DONE, DEAD };
 
-enum fillState { SKIP, PEND, EMPTY, FULL };
+enum fillState { SKIP, PEND, EMPTY, FULL, FAILED };
+
+enum rawFate { RAW_KEEP, RAW_SETTLING, RAW_IDLE };
 
 // Card setup as returned by the dsm/card.
 struct a2d_setup
@@ -76,39 +95,172 @@ public:
     void flush() throw() {}
 
     /// Reassemble a nidas dsmId and sensorId back into id.
-    dsm_sample_id_t id(unsigned int dsmId, unsigned int devId);
+    dsm_sample_id_t id(unsigned int dsmId, unsigned int devId) const;
 
     void setTestVoltage(int dsmId, int devId);
 
     a2d_setup GetA2dSetup(int dsmId, int devId);
 
-    bool Setup(DSMSensor* sensor);
+    /// What a card reported about itself through getA2DSetup.
+    struct SensorProbe {
+        enum rpcStatus status;
+        string fault;                  // faultString when status is RPC_FAULT
+        string card;
+        int nChannels;
+        a2d_setup setup;
+    };
+
+    /**
+     * Ask the card for its current setup.  Only makes the XML-RPC call, so
+     * the cards can be probed concurrently.
+     */
+    enum rpcStatus Probe(DSMSensor* sensor, SensorProbe& probe);
+
+    /**
+     * Check a probed card against its configuration and add its channels.
+     * Returns true if the card can not be calibrated, with a title and
+     * the reason in failure.  Runs on the setup thread, so it shows no
+     * dialogs of its own.
+     */
+    bool Setup(DSMSensor* sensor, const SensorProbe& probe,
+               pair<string, string>& failure);
+
+    /// The calibration history of a card, as read from its CalFile.
+    struct CalHistory {
+        string path;
+        string file;
+        /// time[gain][bplr]
+        map<uint, map<uint, dsm_time_t> > time;
+        /// cals[chn][gain][bplr]
+        map<uint, map<uint, map<uint, vector<double> > > > cals;
+        /// a problem with the CalFile, QMessageBox title and text
+        list<pair<string, string> > warnings;
+        ostringstream log;
+    };
+
+    /**
+     * Read a card's CalFile.  Needs only the sensor and its probe, so the
+     * cards' histories can be read concurrently.
+     */
+    void ReadCalHistory(DSMSensor* sensor, const SensorProbe& probe,
+                        CalHistory& history) const;
+
+    /**
+     * Keep what ReadCalHistory() found; returns true if there was no CalFile.
+     * The caller reports the history's warnings.
+     */
+    bool StoreCalHistory(DSMSensor* sensor, const CalHistory& history);
 
     void createQtTreeModel( map<dsm_sample_id_t, string>dsmLocations );
 
+    /**
+     * Advance every card that has gathered its current level (or that
+     * has not started yet) to its next level.  Each card steps through
+     * its own levels, so a slow card only holds up itself.  Returns DONE
+     * once all of the cards are finished, DEAD if none of them responded.
+     * Calling it with DONE leaves every card open.
+     */
     enum stateEnum SetNextCalVoltage(enum stateEnum state);
 
     bool receive(const Sample* samp) throw();
 
+    /**
+     * Decide whether a raw sample is worth converting, before it enters
+     * the pipeline.  Samples from a card that is still settling, or that
+     * is not gathering at the moment, would only be thrown away by
+     * receive().  Called from the thread that steps the sequences.
+     */
+    enum rawFate RawFate(dsm_sample_id_t rawId, dsm_time_t timeTag) const;
+
+    /// True when at least one card has gathered its current level.
     bool Gathered();
 
+    /**
+     * Watchdog for each card's current level.  Any channel still EMPTY well
+     * past the time its sample rate needs to fill is marked FAILED, so that a
+     * dead card or a rebooting DSM does not hold up the whole fleet.
+     */
+    void CheckStarved();
+
     void DisplayResults();
 
-    int maxProgress() { return nLevels * NSAMPS + 1; };
+    int maxProgress() { return PROGRESS_STEPS + 1; };
+
+    /**
+     * Plan the run from the cards' channel rates, the settle time and the
+     * XML-RPC latencies seen so far, and start timing it against the plan.
+     * Returns the plan as a table; nothing is sent to the cards.
+     */
+    string BuildPlan();
+
+    /// Number of threads DisplayResults() spreads the cards across,
+    /// 0 selects one per available core.
+    void setResultThreads(unsigned int n) { resultThreads = n; };
+
+    /**
+     * Time the DisplayResults() fit of nCards synthetic cards on 1 to
+     * maxThreads threads (0: one per core).  Returns the timings as a table.
+     */
+    string BenchmarkFit(unsigned int nCards, unsigned int maxThreads);
+
+    /// How StartSequences() orders each card's levels.
+    void setLevelOrder(enum levelOrder order) { levelOrdering = order; };
 
     string GetTreeModel() { return QTreeModel.str(); };
 
+    /// The XML-RPC calls to the DSMs; cancel() through here.
+    XmlRpcControl& Control() { return control; };
+
+    /// Problems found along the way, for ErrorReport and the report file.
+    ErrorLog& Errors() { return errors; };
+
+    /// Where the run's time went; see SaveRunReport().
+    RunReport& Report() { return runReport; };
+
+    /// Write the run report next to the saved results in auto_cal/.
+    void SaveRunReport();
+
+    /// When each step ran and on which thread, with --trace.
+    Timeline& Trace() { return timeline; };
+
+    /// What each channel delivered; safe to read while the run goes on.
+    ChannelMetrics& Metrics() { return metrics; };
+
+    /// Each DSM's clock against the host's, fed every raw sample.
+    ClockOffsets& Clocks() { return clocks; };
+
+    /// Voltage levels of each input range; load a plan file before Setup.
+    VoltagePlans& Plans() { return plans; };
+
+    /// Where the capture state is checkpointed after each completed level.
+    void setCheckpointFile(const string& path) { checkpointFile = path; };
+
+    /// Write the levels completed so far to the checkpoint file.
+    void SaveCheckpoint();
+
+    /**
+     * Reload a checkpoint written by an interrupted run and position each
+     * card's level sequence after the last level it completed.  Only channels
+     * that Setup() just verified with the same gain and bipolar settings
+     * are restored.  Returns true on failure.
+     */
+    bool LoadCheckpoint();
+
+    /// Discard the checkpoint once a run has completed.
+    void RemoveCheckpoint();
+
     // Save all cards at once.
     void SaveAllCalFiles();
 
     // Save an individual analog card.
     void SaveCalFile(uint dsmId, uint devId);
 
-    list<int> GetVoltageLevels();
+    /// Every level a card can be set to.
+    const VoltagePlans::Plan& GetVoltageLevels() const;
 
-    list<int> GetVoltageLevels(uint dsmId, uint devId, uint chn);
+    const VoltagePlans::Plan& GetVoltageLevels(uint dsmId, uint devId, uint chn) const;
 
-    string GetVarName(uint dsmId, uint devId, uint chn);
+    const string& GetVarName(uint dsmId, uint devId, uint chn) const;
 
     /**
      * For sensor classes that return a Vdc, do nothing, just return the test
@@ -117,19 +269,47 @@ public:
      */
     float GetVoltageData(uint dsmId, uint devId, uint chn);
 
-    string GetOldTimeStamp(uint dsmId, uint devId, uint chn);
-    string GetNewTimeStamp(uint dsmId, uint devId, uint chn);
+    string GetOldTimeStamp(uint dsmId, uint devId, uint chn) const;
+    string GetNewTimeStamp(uint dsmId, uint devId, uint chn) const;
+
+    float GetOldTemperature(uint dsmId, uint devId, uint chn) const;
+    float GetNewTemperature(uint dsmId, uint devId, uint chn) const;
+
+    /// The Get*Cals() lookups never insert; an unknown channel
+    /// yields an empty vector.
+    const vector<double>& GetOldCals(uint dsmId, uint devId, uint chn) const;
+    const vector<double>& GetNewCals(uint dsmId, uint devId, uint chn) const;
+
+    /// Display strings for one channel, formatted once per run.
+    struct ChannelView {
+        QString varName;
+        QString oldTimeStamp;
+        QString newTimeStamp;
+        QString oldTemperature;
+        QString newTemperature;
+        QString oldIntcp;
+        QString oldSlope;
+        QString newIntcp;
+        QString newSlope;
+    };
 
-    float GetOldTemperature(uint dsmId, uint devId, uint chn);
-    float GetNewTemperature(uint dsmId, uint devId, uint chn);
+    /// ChannelViews[id(dsmId, devId)][chn]
+    typedef map<dsm_sample_id_t, vector<ChannelView> > view_map_type;
 
-    vector<double> GetOldCals(uint dsmId, uint devId, uint chn);
-    vector<double> GetNewCals(uint dsmId, uint devId, uint chn);
+    /**
+     * Snapshot of the display strings for every card.  The GUI holds
+     * on to the snapshot while it fills in a page, so paging through
+     * cards neither allocates nor touches the result maps.
+     */
+    std::shared_ptr<const view_map_type> GetResultViews() const;
 
     unsigned int nLevels;
 
     int progress;
 
+    /// Seconds the run is expected to take yet, -1 before it is planned.
+    int remaining;
+
     typedef map<uint, enum fillState>  channel_a_type; // indexed by chn
     typedef map<uint, channel_a_type>  device_a_type;  // indexed by devId
     typedef map<uint, device_a_type>   dsm_a_type;     // indexed by dsmId
@@ -143,28 +323,118 @@ public:
 
 signals:
     void dispVolts();
-    void errMessage(const QString& message);
     void updateSelection();
 
 public slots:
     void TestVoltage(int channel, int level);
 
 private:
-    bool readCalFile(DSMSensor* sensor, string card);
+    /// Rebuild the ChannelView snapshot from the current results.
+    void BuildResultViews();
 
     string ChnSetDesc(unsigned int val);
 
+    /// One testVoltage SensorAction.
+    struct TestVoltageCmd {
+        uint devId;
+        int state;
+        int level;
+        unsigned char chnSet;
+    };
+
+    /**
+     * Send testVoltage SensorActions to the cards of one DSM, batched into
+     * a single system.multicall request when the DSM supports it and one
+     * call per card otherwise.  faults[i] is set for each command that the
+     * DSM rejected.  Returns true if the DSM did not respond.
+     */
+    bool SendTestVoltages(uint dsmId, const vector<TestVoltageCmd>& cmds,
+                          vector<bool>& faults);
+
+    /// DSMs whose XML-RPC server does not support system.multicall.
+    set<uint> noMulticall;
+
+    /// Build each card's level sequence from calActv, in the chosen order.
+    void StartSequences();
+
+    /// The levels each card needs, from calActv.
+    LevelScheduler::level_sets LevelSets();
+
+    /// Load plan with the cards' levels in orders, their rates and switch times.
+    void FillPlanner(RunPlanner& plan, const LevelScheduler::level_orders& orders);
+
+    /// The order whose simulated run finishes first.
+    enum levelOrder FastestOrder(const LevelScheduler::level_sets& sets);
+
+    /**
+     * Recompute remaining and progress from the card furthest from
+     * finishing: what is left of its current level, going by how far it
+     * has filled, and the planner's estimate of its levels to come.
+     */
+    void UpdateProgress();
+
+    RunPlanner planner;
+
+    /// When BuildPlan() started timing the run.
+    RunReport::clock::time_point planStart;
+
+    XmlRpcControl control;
+
+    ErrorLog errors;
+
+    RunReport runReport;
+
+    Timeline timeline;
+
+    ChannelMetrics metrics;
+
+    ClockOffsets clocks;
+
     bool testVoltage;
     int tvDsmId;
     int tvDevId;
 
     ostringstream QTreeModel;
-    ostringstream QStrBuf;
 
-    dsm_time_t lastTimeStamp;
+    /**
+     * Voltage level sequence of one card.  Each card switches to its next
+     * level as soon as its own channels are FULL (or FAILED), so its settle
+     * time overlaps the other cards that are still gathering.
+     */
+    struct Sequence {
+        uint dsmId;
+        uint devId;
+        vector<int> levels;        // levels this card needs, in order
+        size_t next;               // index into levels of the next level to apply
+        int level;                 // active voltage level
+        bool active;               // level applied, gathering
+        bool gathered;             // every channel at level is FULL or FAILED
+        bool done;                 // all levels gathered, cards left open
+        bool dead;                 // card or its DSM stopped responding
+        dsm_time_t settleStart;    // host time this card's level was applied, see SettleEnd()
+        RunReport::clock::time_point switched;   // for the run report
+        RunReport::clock::time_point settled;
+        bool settling;             // no sample has been kept at level yet
+    };
+
+    /// sequences[id(dsmId, devId)]
+    map<dsm_sample_id_t, Sequence> sequences;
+
+    /**
+     * Advance the sequences of some of one DSM's cards, switching them
+     * with a single request.  Returns true if the DSM did not respond.
+     */
+    bool StepSequences(uint dsmId, const list<Sequence*>& seqs);
+
+    /// DSM time tag from which a card's samples at its level are kept.
+    dsm_time_t SettleEnd(const Sequence& seq) const;
+
+    string checkpointFile;
 
-    /// voltageLevels["GB"]   indexed by "1T", "2F", "2T", or "4F"
-    map<string, list <int> > voltageLevels;
+    /// Channels the watchdog gave up on, and why.
+    list<string> givenUp;
+
+    VoltagePlans plans;
 
     struct sA2dSampleInfo {
         uint dsmId;
@@ -193,11 +463,8 @@ private:
     /// calData[dsmId][devId][chn][level]
     dsm_d_type calData;
 
-    /// index to active voltage level
-    int idxVltLvl;
-
-    /// active voltage level
-    int VltLvl;
+    /// outlierFilter[dsmId][devId][chn][level]
+    map<uint, map<uint, map<uint, map<int, numeric::RobustFilter> > > > outlierFilter;
 
     /// isNAN[dsmId][devId][chn][level]
     map<uint, map<uint, map<uint, map<uint, bool> > > > isNAN;
@@ -229,6 +496,9 @@ private:
     /// Bplrs[dsmId][devId][chn]
     map<uint, map<uint, map<uint, int> > > Bplrs;
 
+    /// PlanCodes[dsmId][devId][chn], a planCode
+    map<uint, map<uint, map<uint, int> > > PlanCodes;
+
     /// timeStamp[dsmId][devId][chn]
     map<uint, map<uint, map<uint, dsm_time_t> > > timeStamp;
 
@@ -241,6 +511,52 @@ private:
     /// resultIntcp[dsmId][devId][chn][gain][bplr]
     map<uint, map<uint, map<uint, map<uint, map<uint, vector<double> > > > > > resultCals;
 
+    /// Per-card inputs to the fit, copied out of the shared maps so that
+    /// DisplayResults() can reduce the cards concurrently.
+    struct CardJob {
+        uint dsmId;
+        uint devId;
+        uint nChannels;
+        string dsmName;
+        string devName;
+        string calFileName;
+        const channel_d_type* Channels;
+        const data_d_type* temperature;
+        map<uint, int> gains;                          // indexed by chn
+        map<uint, int> bplrs;                          // indexed by chn
+        map<uint, dsm_time_t> timeStamp;               // indexed by chn
+        map<uint, map<int, uint> > rejected;           // indexed by chn, level
+        map<uint, map<int, uint> > nonFinite;          // NaN or inf samples, indexed by chn, level
+    };
+
+    /// Per-card outputs of the fit, merged back in card order.
+    struct CardResult {
+        string log;
+        map<uint, vector<double> > cals;               // indexed by chn
+        float temperature;
+        string calFileResults;
+        string devErr;
+        list<pair<uint, int> > nanLevels;              // (chn, level)
+        list<string> nanErrs;
+        vector<float> voltageMin;
+        vector<float> voltageMax;
+    };
+
+    static CardResult ComputeCardResults(const CardJob& job);
+
+    /// Reduce jobs on nThreads threads, results in job order.
+    vector<CardResult> FitCards(const vector<CardJob>& jobs, unsigned int nThreads);
+
+    unsigned int resultThreads;
+
+    enum levelOrder levelOrdering;
+
+    /// levelOrdering, with ORDER_FASTEST resolved
+    enum levelOrder usedOrder;
+
+    mutable std::mutex viewMutex;
+    std::shared_ptr<const view_map_type> resultViews;
+
     level_a_type::iterator    iLevel;
     dsm_a_type::iterator      iDsm;
     device_a_type::iterator   iDevice;
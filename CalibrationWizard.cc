@@ -26,6 +26,7 @@
 // design taken from 'examples/dialogs/licensewizard'
 
 #include "CalibrationWizard.h"
+#include "ErrorReport.h"
 #include "TestA2DPage.h"
 #include "Calibrator.h"
 #include "PolyEval.h"
@@ -56,6 +57,9 @@ CalibrationWizard::CalibrationWizard(Calibrator *calib, AutoCalClient *acc, QWid
     setOption(QWizard::IndependentPages,        true);
     setOption(QWizard::NoCancelButton,          true);
 
+    // Its own window, so the progress dialogs do not block it.
+    _ErrorReport = new ErrorReport(&acc->Errors());
+
     _SetupPage   = new SetupPage(calib);
     _TestA2DPage = new TestA2DPage(calib, acc);
     _AutoCalPage = new AutoCalPage(calib, acc);
@@ -80,6 +84,7 @@ CalibrationWizard::CalibrationWizard(Calibrator *calib, AutoCalClient *acc, QWid
     sigaddset(&sigset,SIGHUP);
     sigaddset(&sigset,SIGINT);
     sigaddset(&sigset,SIGTERM);
+    sigaddset(&sigset,SIGUSR1);
     sigprocmask(SIG_UNBLOCK,&sigset,(sigset_t*)0);
 
     struct sigaction act;
@@ -90,6 +95,7 @@ CalibrationWizard::CalibrationWizard(Calibrator *calib, AutoCalClient *acc, QWid
     sigaction(SIGHUP ,&act,(struct sigaction *)0);
     sigaction(SIGINT ,&act,(struct sigaction *)0);
     sigaction(SIGTERM,&act,(struct sigaction *)0);
+    sigaction(SIGUSR1,&act,(struct sigaction *)0);
 
     // setup sockets to receive UNIX signals
     if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalFd))
@@ -103,6 +109,7 @@ CalibrationWizard::CalibrationWizard(Calibrator *calib, AutoCalClient *acc, QWid
 CalibrationWizard::~CalibrationWizard()
 {
     delete _snSignal;
+    delete _ErrorReport;
     delete _AutoCalPage;
     delete _TestA2DPage;
     delete _SetupPage;
@@ -118,6 +125,12 @@ void CalibrationWizard::cleanup(int sig, siginfo_t* siginfo, void* vptr)
         ", si_errno=" << (siginfo ? siginfo->si_errno : -1) <<
         ", si_code=" << (siginfo ? siginfo->si_code : -1) << endl;
 
+    // SIGUSR1 only asks for the channel metrics, the run goes on
+    if (sig == SIGUSR1) {
+        char m = 2;
+        ::write(signalFd[0], &m, sizeof(m));
+        return;
+    }
 
     // Clear any residual auto-cal
     acc->SetNextCalVoltage(DONE);
@@ -139,6 +152,10 @@ void CalibrationWizard::handleSignal()
     char tmp;
     ::read(signalFd[1], &tmp, sizeof(tmp));
 
+    if (tmp == 2) {
+        cout << acc->Metrics().report();
+        return;
+    }
     // do Qt stuff
     emit close();
 }
@@ -151,6 +168,7 @@ int CalibrationWizard::signalFd[2]  = {0, 0};
 void CalibrationWizard::accept()
 {
     calibrator->cancel();
+    calibrator->finishSetup();
     calibrator->wait();
     QWizard::accept();
 }
@@ -162,6 +180,7 @@ void CalibrationWizard::closeEvent(QCloseEvent *event)
     if (!calibrator) return;
 
     calibrator->cancel();
+    calibrator->finishSetup();
     calibrator->wait();
     exit(0);
 }
@@ -210,7 +229,7 @@ int SetupPage::nextId() const
 /* ---------------------------------------------------------------------------------------------- */
 
 AutoCalPage::AutoCalPage(Calibrator *calib, AutoCalClient *acc, QWidget *parent)
-    : QWizardPage(parent), dsmId(-1), devId(-1), calibrator(calib), acc(acc)
+    : QWizardPage(parent), dsmId(-1), devId(-1), calibrator(calib), acc(acc), discovery(0)
 {
     setTitle(tr("Auto Calibration"));
     setSubTitle(tr("Select a card from the tree to review the results."));
@@ -256,25 +275,27 @@ void AutoCalPage::createTree()
     cout << "AutoCalPage::createTree" << endl;
     treeView = new QTreeView();
 
-    // extract the tree from AutoCalClient.
-    cout << acc->GetTreeModel();
-    treeModel = new TreeModel( QString(acc->GetTreeModel().c_str()) );
+    // starts out empty, cardDiscovered() fills it in.
+    treeModel = new TreeModel( QString() );
 
     // Initialize the QTreeView
     treeView->setModel(treeModel);
-    treeView->expandAll();
     treeView->setMinimumWidth(300);
-    treeView->resizeColumnToContents(0);
-    treeView->resizeColumnToContents(1);
-    treeView->resizeColumnToContents(2);
 
     // The dsmId(s) and devId(s) are hidden in the 3rd column.
 //  treeView->hideColumn(2);
+}
 
-    connect(treeView->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
-                                    this, SLOT(selectionChanged(const QItemSelection&, const QItemSelection&)));
 
-    treeView->setCurrentIndex(treeView->model()->index(0,0));
+void AutoCalPage::cardDiscovered(const QString& location, const QString& dsmName, unsigned int dsmId,
+                                 const QString& calFile, const QString& devName, unsigned int devId)
+{
+    Timeline::Span span(acc->Trace(), "cardDiscovered");
+    treeModel->addCard(location, dsmName, dsmId, calFile, devName, devId);
+    treeView->expandAll();
+    treeView->resizeColumnToContents(0);
+    treeView->resizeColumnToContents(1);
+    treeView->resizeColumnToContents(2);
 }
 
 
@@ -296,20 +317,31 @@ void AutoCalPage::selectionChanged(const QItemSelection &selected, const QItemSe
     QModelIndex dsmIdx = parent.sibling(parent.row(), 2);
     dsmId = treeModel->data(dsmIdx, Qt::DisplayRole).toInt();
 
+    // hold on to one snapshot of the results while filling in the page
+    std::shared_ptr<const AutoCalClient::view_map_type> views = acc->GetResultViews();
+
+    // a card with no results yet shows blanks, not the last card's values
+    static const AutoCalClient::ChannelView blank;
+    AutoCalClient::view_map_type::const_iterator iCard = views->find(acc->id(dsmId, devId));
+
     for (int chn = 0; chn < numA2DChannels; chn++) {
-        VarName[chn]->setText( QString( acc->GetVarName(dsmId, devId, chn).c_str() ) );
+        const AutoCalClient::ChannelView& view =
+          (iCard != views->end() && (size_t)chn < iCard->second.size()) ?
+            iCard->second[chn] : blank;
+
+        VarName[chn]->setText( view.varName );
 
-        OldTimeStamp[chn]->setText( QString( acc->GetOldTimeStamp(dsmId, devId, chn).c_str() ) );
-        NewTimeStamp[chn]->setText( QString( acc->GetNewTimeStamp(dsmId, devId, chn).c_str() ) );
+        OldTimeStamp[chn]->setText( view.oldTimeStamp );
+        NewTimeStamp[chn]->setText( view.newTimeStamp );
 
-        OldTemperature[chn]->setText( QString::number( acc->GetOldTemperature(dsmId, devId, chn) ) );
-        NewTemperature[chn]->setText( QString::number( acc->GetNewTemperature(dsmId, devId, chn) ) );
+        OldTemperature[chn]->setText( view.oldTemperature );
+        NewTemperature[chn]->setText( view.newTemperature );
 
-        OldIntcp[chn]->setText( QString::number( acc->GetOldCals(dsmId, devId, chn)[0] ) );
-        NewIntcp[chn]->setText( QString::number( acc->GetNewCals(dsmId, devId, chn)[0] ) );
+        OldIntcp[chn]->setText( view.oldIntcp );
+        NewIntcp[chn]->setText( view.newIntcp );
 
-        OldSlope[chn]->setText( QString::number( acc->GetOldCals(dsmId, devId, chn)[1] ) );
-        NewSlope[chn]->setText( QString::number( acc->GetNewCals(dsmId, devId, chn)[1] ) );
+        OldSlope[chn]->setText( view.oldSlope );
+        NewSlope[chn]->setText( view.newSlope );
     }
 }
 
@@ -389,19 +421,64 @@ void AutoCalPage::initializePage()
 {
     cout << "AutoCalPage::initializePage" << endl;
 
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    if (calibrator->setup("acserver", "cal")) return;
-    QApplication::restoreOverrideCursor();
-
     createTree();
-    createGrid();
 
     mainLayout = new QHBoxLayout;
     mainLayout->addWidget(treeView);
-    mainLayout->addWidget(gridGroupBox);
 
     setLayout(mainLayout);
 
+    // The cards are discovered on the Calibrator's setup thread, so these
+    // are all Qt::QueuedConnection(s).
+    connect(calibrator, SIGNAL(cardDiscovered(const QString&, const QString&, unsigned int,
+                                              const QString&, const QString&, unsigned int)),
+            this,         SLOT(cardDiscovered(const QString&, const QString&, unsigned int,
+                                              const QString&, const QString&, unsigned int)));
+
+    connect(calibrator, SIGNAL(setupFinished(bool)),
+            this,         SLOT(setupFinished(bool)));
+
+    discovery = new QProgressDialog(tr("Searching the DSMs for analog cards..."),
+                                    tr("Cancel"), 0, 0, this);
+    discovery->setWindowTitle(tr("Discovering..."));
+    discovery->setWindowModality(Qt::WindowModal);
+
+    connect(discovery,  SIGNAL(canceled()),
+            calibrator,   SLOT(cancel()) );
+
+    discovery->show();
+
+    QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
+    calibrator->startSetup("acserver", "cal");
+}
+
+
+void AutoCalPage::setupFinished(bool failed)
+{
+    calibrator->finishSetup();
+
+    discovery->hide();
+    discovery->deleteLater();
+    discovery = 0;
+
+    QApplication::restoreOverrideCursor();
+    if (failed) return;
+
+    cout << "launch to card tree: " << calibrator->sinceLaunch() << " ms" << endl;
+
+    createGrid();
+    mainLayout->addWidget(gridGroupBox);
+
+    connect(treeView->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
+                                    this, SLOT(selectionChanged(const QItemSelection&, const QItemSelection&)));
+
+    treeView->setCurrentIndex(treeView->model()->index(0,0));
+
+    // a dry run stops at the plan, with the cards' current cals on show
+    if (calibrator->planOnly()) {
+        cout << acc->BuildPlan();
+        return;
+    }
     qPD = new QProgressDialog(this);
     qPD->setRange(0, acc->maxProgress() );
     qPD->setWindowTitle(tr("Auto Calibrating..."));
@@ -410,11 +487,11 @@ void AutoCalPage::initializePage()
     // This connection spans across threads so it is a
     // Qt::QueuedConnection by default.
     // (http://doc.qt.nokia.com/4.6/threads-mandelbrot.html)
-    connect(acc,  SIGNAL(errMessage(const QString&)),
-            this,   SLOT(errMessage(const QString&)));
-
     connect(calibrator, SIGNAL(setValue(int)),
-            qPD,          SLOT(setValue(int)) );
+            this,         SLOT(setValue(int)) );
+
+    connect(calibrator, SIGNAL(setRemaining(int)),
+            this,         SLOT(setRemaining(int)) );
 
     connect(qPD,        SIGNAL(canceled()),
             calibrator,   SLOT(cancel()) );
@@ -423,13 +500,19 @@ void AutoCalPage::initializePage()
 }
 
 
-void AutoCalPage::errMessage(const QString& message)
-{
-    QMessageBox::warning(this, "error", message);
-}
-
-
 void AutoCalPage::setValue(int progress)
 {
+    Timeline::Span span(acc->Trace(), "setValue");
     qPD->setValue(progress);
 };
+
+
+void AutoCalPage::setRemaining(int seconds)
+{
+    ostringstream ostr;
+    ostr << "About ";
+    if (seconds >= 60)
+        ostr << seconds / 60 << " min ";
+    ostr << seconds % 60 << " s left";
+    qPD->setLabelText(QString::fromStdString(ostr.str()));
+}
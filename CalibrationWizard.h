@@ -60,6 +60,7 @@ QT_END_NAMESPACE
 class SetupPage;
 class TestA2DPage;
 class AutoCalPage;
+class ErrorReport;
 
 /**
  * GUI logic for auto calibration tool.  Creates either AutoCalPage or TestA2DPage
@@ -107,6 +108,8 @@ private:
     TestA2DPage* _TestA2DPage;
     AutoCalPage* _AutoCalPage;
 
+    ErrorReport* _ErrorReport;
+
     QSocketNotifier *_snSignal;
 };
 
@@ -143,12 +146,15 @@ public:
     QProgressDialog* qPD;
 
 public slots:
-    void errMessage(const QString& message);
     void setValue(int progress);
+    void setRemaining(int seconds);
     void selectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
 
 private slots:
     void saveButtonClicked();
+    void cardDiscovered(const QString& location, const QString& dsmName, unsigned int dsmId,
+                        const QString& calFile, const QString& devName, unsigned int devId);
+    void setupFinished(bool failed);
 
 private:
     int dsmId;
@@ -169,6 +175,9 @@ private:
     QButtonGroup *buttonGroup;
     QHBoxLayout *mainLayout;
 
+    /// Busy indicator with a Cancel button while the cards are discovered.
+    QProgressDialog *discovery;
+
     enum { numA2DChannels = 8 };    // We only auto_cal ncar_a2d cards.
 
     QLabel *ChannelTitle;
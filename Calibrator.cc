@@ -25,8 +25,19 @@
 */
 #include "Calibrator.h"
 #include "AutoCalClient.h"
+#include "ConfigCache.h"
 
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <list>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <unistd.h>
 
 #include <nidas/core/Socket.h>
 #include <nidas/core/DSMConfig.h>
@@ -44,7 +55,6 @@
 #include <nidas/core/FileSet.h>
 #endif
 
-#include <QMessageBox>
 
 using namespace nidas::core;
 using namespace nidas::dynld;
@@ -55,6 +65,62 @@ namespace n_u = nidas::util;
 
 string stateEnumDesc[] = {"GATHER", "DONE", "DEAD" };
 
+// raw samples queued between the reader thread and the analysis thread
+#define RING_CAPACITY 8192
+
+// samples analysed per pump(), and how long pump() idles when there are
+// none (microseconds)
+#define PUMP_BATCH 256
+#define PUMP_WAIT 1000
+
+// longest the reader blocks waiting for data before it looks for a
+// cancel or stop request (milliseconds)
+#define READ_TIMEOUT 100
+
+// how long the DSMs get to accept a connection on their XML-RPC port
+// during the reachability sweep (seconds)
+#define REACH_TIMEOUT 1.0
+
+// most threads used to probe the cards and read their CalFiles
+#define SETUP_THREADS 16
+
+/// CPU seconds used so far, as counted by clock.
+static double cpuSeconds(clockid_t clock)
+{
+    struct timespec ts;
+    if (::clock_gettime(clock, &ts))
+        return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+
+/**
+ * Call fn(i) for every i in [0, n) on up to nThreads threads.  Each
+ * worker pulls the next index, so fn must only touch the i'th entry of
+ * whatever it fills in.
+ */
+template <typename F>
+static void parallelFor(size_t n, unsigned int nThreads, F fn)
+{
+    if (nThreads > n)
+        nThreads = n;
+
+    atomic<size_t> next(0);
+    vector<std::thread> workers;
+    for (unsigned int t = 0; t < nThreads; t++)
+        workers.push_back(std::thread([n, &next, &fn]() {
+            for (size_t i = next++; i < n; i = next++)
+                fn(i);
+        }));
+    for (unsigned int t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+static long msecs(chrono::steady_clock::time_point t0, chrono::steady_clock::time_point t1)
+{
+    return chrono::duration_cast<chrono::milliseconds>(t1 - t0).count();
+}
+
 class AutoProject
 {
 public:
@@ -64,12 +130,33 @@ public:
 
 Calibrator::Calibrator( AutoCalClient *acc ):
    _testVoltage(false),
+   _resume(false),
+   _direct(false),
+   _planOnly(false),
+   _launchTime(std::chrono::steady_clock::now()),
    _canceled(false),
    _acc(acc),
    _sis(0),
+   _filter(0),
+   _ring(0),
+   _iochan(0),
+   _reading(false),
+   _readerDone(false),
+   _readerCpu(0.0),
    _pipeline(0)
 {
+    // constructed on the GUI thread; its CPU is left out of the decode CPU
+    if (::pthread_getcpuclockid(::pthread_self(), &_guiClock))
+        _guiClock = CLOCK_THREAD_CPUTIME_ID;
     AutoProject project;
+
+    // written to by cancel() and stopReader() to wake a waiting reader
+    if (::pipe(_wakeup) == 0) {
+        ::fcntl(_wakeup[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(_wakeup[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+        _wakeup[0] = _wakeup[1] = -1;
 }
 
 
@@ -77,18 +164,58 @@ Calibrator::~Calibrator()
 {
     cout << "Calibrator::~Calibrator" << endl;
 
-    if (_pipeline)
+    if (_pipeline && !_direct)
         _pipeline->getProcessedSampleSource()->removeSampleClient(_acc);
 
+    if (_setupThread.joinable()) {
+        cancel();
+        finishSetup();
+    }
     if (isRunning()) {
         cancel();
         wait();
     }
+    if (_ring)
+        stopReader();
+
     delete _sis;
+    delete _ring;
+    delete _filter;
     delete _pipeline;
+
+    if (_wakeup[0] >= 0) {
+        ::close(_wakeup[0]);
+        ::close(_wakeup[1]);
+    }
 };
 
 
+long Calibrator::sinceLaunch() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - _launchTime).count();
+}
+
+
+void Calibrator::startSetup(QString host, QString mode)
+{
+    finishSetup();
+    _setupThread = std::thread([this, host, mode]() {
+        _acc->Trace().nameThread("setup");
+        bool failed = setup(host, mode);
+        _acc->Trace().write();
+        emit setupFinished(failed);
+    });
+}
+
+
+void Calibrator::finishSetup()
+{
+    if (_setupThread.joinable())
+        _setupThread.join();
+}
+
+
 bool Calibrator::setup(QString host, QString mode)
 {
     cout << "Calibrator::setup(), mode=[" << mode.toStdString() << "]\n";
@@ -113,9 +240,16 @@ bool Calibrator::setup(QString host, QString mode)
         cout << "Calibrator::setup() connected to dsm_server" << endl;
 #endif
 
+        _iochan = iochan;
         _sis = new RawSampleInputStream(iochan); // RawSampleStream now owns the iochan ptr.
         _sis->setMaxSampleLength(32768);
 
+        // drops raw samples the client has no use for before conversion
+        _filter = new RawSampleFilter(_acc, &_acc->Metrics());
+
+        // carries raw samples from the reader thread to this one
+        _ring = new SampleRing(RING_CAPACITY);
+
         cout << "Calibrator::setup() RawSampleStream now owns the iochan ptr." << endl;
 
         // Address to use when fishing for the XML configuration.
@@ -129,81 +263,265 @@ bool Calibrator::setup(QString host, QString mode)
             ostringstream ostr;
             ostr << "Failed to aquire XML configuration: " << e.what();
             cout << ostr.str() << endl;
-            QMessageBox::critical(0, "CANNOT start", ostr.str().c_str());
+            _acc->Errors().post(ERR_ERROR, "", "", "CANNOT start", ostr.str());
             return true;
         }
         // Pull in the XML configuration from the DSM server.
+        struct timespec t0, t1, t2;
+        ::clock_gettime(CLOCK_MONOTONIC, &t0);
         n_u::auto_ptr<xercesc::DOMDocument> doc(requestXMLConfig(true,_configSockAddr));
+        ::clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        // dsm_server has no way to ask for just a version, so the whole
+        // configuration is fetched every time; what the cache saves is
+        // building every non-analog sensor in it.
+        ConfigCache cache(_configCache);
+        unsigned long long hash = ConfigCache::Hash(doc->getDocumentElement());
+        bool cached = cache.load(host.toStdString(), hash);
+        unsigned int pruned = 0;
+        if (cached)
+            pruned = cache.prune(doc->getDocumentElement());
 
         Project::getInstance()->fromDOMElement(doc->getDocumentElement());
         doc.release();
+        ::clock_gettime(CLOCK_MONOTONIC, &t2);
+
+        _acc->Report().add("config fetch", host.toStdString(),
+                           (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1.0e-9);
+        _acc->Report().add("config parse", cached ? "cached" : "full",
+                           (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec) * 1.0e-9);
+
+        cout << "XML configuration: fetched in " << (t1.tv_sec - t0.tv_sec) * 1000 +
+                (t1.tv_nsec - t0.tv_nsec) / 1000000 << " ms, parsed in " <<
+                (t2.tv_sec - t1.tv_sec) * 1000 + (t2.tv_nsec - t1.tv_nsec) / 1000000 <<
+                " ms, cache " << (cached ? "hit" : "miss");
+        if (cached)
+            cout << " (" << pruned << " sensors pruned)";
+        cout << endl;
+
+        {
+            // Note which sensors are analog, and on a hit make sure the
+            // pruned configuration still holds every one of them.
+            bool intact = true;
+            DSMConfigIterator di = Project::getInstance()->getDSMConfigIterator();
+            for ( ; di.hasNext(); ) {
+                const DSMConfig* dsm = di.next();
+                const list<DSMSensor*>& allSensors = dsm->getSensors();
+                size_t nAnalog = 0;
+
+                if (!cached)
+                    cache.add(dsm->getName());
+
+                list<DSMSensor*>::const_iterator si;
+                for (si = allSensors.begin(); si != allSensors.end(); ++si) {
+                    if (!ConfigCache::IsAnalog((*si)->getClassName()))
+                        continue;
+                    nAnalog++;
+                    if (!cached)
+                        cache.add(dsm->getName(), (*si)->getDeviceName());
+                }
+                if (cached && nAnalog < cache.count(dsm->getName()))
+                    intact = false;
+            }
+            if (!cached)
+                cache.save(host.toStdString(), hash);
+            else if (!intact) {
+                // the next launch does a full parse and rebuilds it
+                cout << "XML configuration cache lost analog sensors, discarding it" << endl;
+                cache.invalidate();
+            }
+        }
 
         bool noneFound = true;
 
+#ifndef SIMULATE
+        // Sweep all of the DSMs at once, rather than finding the powered
+        // down ones one XML-RPC timeout at a time in AutoCalClient::Setup().
+        set<string> reachable;
+        {
+            list<string> hosts;
+            DSMConfigIterator di = Project::getInstance()->getDSMConfigIterator();
+            for ( ; di.hasNext(); )
+                hosts.push_back(di.next()->getName());
+
+            ::clock_gettime(CLOCK_MONOTONIC, &t0);
+            reachable = XmlRpcControl::Reachable(hosts, REACH_TIMEOUT);
+            ::clock_gettime(CLOCK_MONOTONIC, &t1);
+
+            cout << "reachability: " << reachable.size() << " of " << hosts.size()
+                 << " DSMs answered in " << (t1.tv_sec - t0.tv_sec) * 1000 +
+                    (t1.tv_nsec - t0.tv_nsec) / 1000000 << " ms" << endl;
+        }
+#endif
+
         _pipeline = new SamplePipeline();
         cout << "_pipeline: " << _pipeline << endl;
 
+        // Setup runs in phases: probe the cards, load their calibration
+        // history, initialize the sensors, then wire them to the pipeline.
+        // The per-sensor work of each phase runs concurrently; anything
+        // that touches shared state or the GUI is done here in between.
+        vector<DSMSensor*> candidates;
+        vector<const DSMConfig*> candidateDsms;
+
         DSMConfigIterator di = Project::getInstance()->getDSMConfigIterator();
         for ( ; di.hasNext(); ) {
             const DSMConfig* dsm = di.next();
             const list<DSMSensor*>& allSensors = dsm->getSensors();
 
+#ifndef SIMULATE
+            // a DSM that is down is often just off, so it is only logged
+            if (!reachable.count(dsm->getName())) {
+                cout << "skipping unreachable DSM " << dsm->getName() << endl;
+                _acc->Errors().post(ERR_INFO, dsm->getName(), "", "xmlrpc client NOT responding",
+                                    "DSM did not answer the reachability sweep; skipping its cards");
+                continue;
+            }
+#endif
+
             list<DSMSensor*>::const_iterator si;
             for (si = allSensors.begin(); si != allSensors.end(); ++si) {
                 DSMSensor* sensor = *si;
 
-                if (_canceled)
-                    return true;
-
                 // skip non-Analog type sensors
                 // Cal mode is for ncar_a2d only.  Diag nostic mode is for all
                 if (mode == "cal" && sensor->getClassName().compare("raf.DSMAnalogSensor"))
                     continue;
-                if (sensor->getClassName().compare("raf.DSMAnalogSensor") &&    // ncar_a2d
-                    sensor->getClassName().compare("DSC_A2DSensor") &&  // Diamond - ddmat
-                    sensor->getClassName().compare("raf.A2D_Serial"))   // gpDAQ
+                if (!ConfigCache::IsAnalog(sensor->getClassName()))
                     continue;
 
-                // skip non-responsive of miss-configured sensors
-                if ( _acc->Setup(sensor) )
-                    continue;
+                candidates.push_back(sensor);
+                candidateDsms.push_back(dsm);
+            }
+        }
 
-                dsmLocations[dsm->getId()] = dsm->getLocation();
-
-                // DEBUG - print out the found calibration coeffients
-                uint dsmId = sensor->getDSMId();
-                uint devId = sensor->getSensorId();
-                for (uint chn = 0; chn < 8; chn++) {
-                    if (_acc->GetOldCals(dsmId, devId, chn).size() > 1) {
-                        cout << __PRETTY_FUNCTION__;
-                        cout << " dsmId: " << dsmId << " devId: " << devId << " chn: " << chn;
-                        cout << " nCals: " << _acc->GetOldCals(dsmId, devId, chn).size();
-                        cout << " Intcp: " << _acc->GetOldCals(dsmId, devId, chn)[0];
-                        cout << " Slope: " << _acc->GetOldCals(dsmId, devId, chn)[1];
-                        cout << endl;
-                    }
+        // discover: probe each card and read its CalFile concurrently.  As
+        // each card comes back it is accepted under the lock and streamed
+        // to the page, so the tree fills in while the rest are still out.
+        chrono::steady_clock::time_point p0 = chrono::steady_clock::now();
+        vector<AutoCalClient::SensorProbe> probes(candidates.size());
+        vector<AutoCalClient::CalHistory> histories(candidates.size());
+        vector<bool> accepted(candidates.size(), false);
+        atomic<long> probeTime(0), historyTime(0);
+        mutex acceptMutex;
+
+        parallelFor(candidates.size(), SETUP_THREADS, [&](size_t i) {
+            DSMSensor* sensor = candidates[i];
+            string card = sensor->getDSMName() + ":" + sensor->getDeviceName();
+            _acc->Trace().nameThread("setup worker");
+
+            chrono::steady_clock::time_point c0 = chrono::steady_clock::now();
+            _acc->Probe(sensor, probes[i]);
+            chrono::steady_clock::time_point c1 = chrono::steady_clock::now();
+            _acc->Trace().add("Probe", c0, card);
+            if (probes[i].status == RPC_OK && !_canceled) {
+                _acc->ReadCalHistory(sensor, probes[i], histories[i]);
+                _acc->Trace().add("ReadCalHistory", c1, card);
+            }
+            chrono::steady_clock::time_point c2 = chrono::steady_clock::now();
+            probeTime += msecs(c0, c1);
+            historyTime += msecs(c1, c2);
+
+            _acc->Report().add("probe", card, chrono::duration<double>(c1 - c0).count());
+            if (c2 > c1)
+                _acc->Report().add("calfile read", card, chrono::duration<double>(c2 - c1).count());
+
+            if (_canceled)
+                return;
+
+            lock_guard<mutex> lock(acceptMutex);
+
+            // skip non-responsive of miss-configured sensors; their DSM
+            // was reachable, so losing the card is an error
+            pair<string, string> failure;
+            if ( _acc->Setup(sensor, probes[i], failure) ) {
+                _acc->Errors().post(ERR_ERROR, sensor->getDSMName(), sensor->getDeviceName(),
+                                    failure.first, failure.second);
+                return;
+            }
+            _acc->StoreCalHistory(sensor, histories[i]);
+
+            list<pair<string, string> >::const_iterator iW;
+            for (iW = histories[i].warnings.begin(); iW != histories[i].warnings.end(); iW++)
+                _acc->Errors().post(ERR_WARNING, sensor->getDSMName(), sensor->getDeviceName(),
+                                    iW->first, iW->second);
+
+            // DEBUG - print out the found calibration coeffients
+            uint dsmId = sensor->getDSMId();
+            uint devId = sensor->getSensorId();
+            for (uint chn = 0; chn < 8; chn++) {
+                if (_acc->GetOldCals(dsmId, devId, chn).size() > 1) {
+                    cout << __PRETTY_FUNCTION__;
+                    cout << " dsmId: " << dsmId << " devId: " << devId << " chn: " << chn;
+                    cout << " nCals: " << _acc->GetOldCals(dsmId, devId, chn).size();
+                    cout << " Intcp: " << _acc->GetOldCals(dsmId, devId, chn)[0];
+                    cout << " Slope: " << _acc->GetOldCals(dsmId, devId, chn)[1];
+                    cout << endl;
                 }
-                // default slopes and intersects to 1.0 and 0.0
-                sensor->removeCalFiles();
+            }
+            const DSMConfig* dsm = candidateDsms[i];
+            dsmLocations[dsm->getId()] = dsm->getLocation();
+            accepted[i] = true;
+
+            emit cardDiscovered(QString::fromStdString(dsm->getLocation()),
+                                QString::fromStdString(dsm->getName()), dsmId,
+                                QString::fromStdString(histories[i].file.empty() ?
+                                                       "---" : histories[i].file),
+                                QString::fromStdString(sensor->getDeviceName()), devId);
+        });
+        if (_canceled)
+            return true;
 
-                // initialize the sensor
-                sensor->init();
+        // keep the configuration's order, not the order the cards answered in
+        vector<DSMSensor*> sensors;
+        for (size_t i = 0; i < candidates.size(); i++)
+            if (accepted[i])
+                sensors.push_back(candidates[i]);
 
-                //  inform the SampleInputStream of what SampleTags to expect
-                cout << "_sis->addSampleTag(sensor->getRawSampleTag());" << endl;
-                _sis->addSampleTag(sensor->getRawSampleTag());
+        // init: local and cheap, and nidas' sensor init shares project
+        // and logging state, so one sensor at a time
+        chrono::steady_clock::time_point p1 = chrono::steady_clock::now();
+        for (size_t i = 0; i < sensors.size(); i++) {
+            RunReport::Timer timer(_acc->Report(), "init",
+                                   sensors[i]->getDSMName() + ":" + sensors[i]->getDeviceName());
 
-                // connect to the _pipeline member
-                _pipeline->connect(sensor);
+            // default slopes and intersects to 1.0 and 0.0
+            sensors[i]->removeCalFiles();
 
-                noneFound = false;
-            }
+            // initialize the sensor
+            sensors[i]->init();
         }
+
+        // wire: the input stream, filter and pipeline are not thread safe
+        chrono::steady_clock::time_point p2 = chrono::steady_clock::now();
+        for (size_t i = 0; i < sensors.size(); i++) {
+            DSMSensor* sensor = sensors[i];
+
+            //  inform the SampleInputStream of what SampleTags to expect
+            _sis->addSampleTag(sensor->getRawSampleTag());
+            _filter->addSampleTag(sensor->getRawSampleTag());
+            _filter->addSensor(sensor);
+
+            // connect to the _pipeline member
+            _pipeline->connect(sensor);
+
+            noneFound = false;
+        }
+        chrono::steady_clock::time_point p3 = chrono::steady_clock::now();
+        _acc->Report().add("wire", "", p2);
+        _acc->Report().add("discover", "", chrono::duration<double>(p1 - p0).count());
+
+        // probe and cal history are summed over the cards, which overlap
+        cout << "setup phases: discover " << msecs(p0, p1) << " ms (" << candidates.size()
+             << " cards; probe " << probeTime << " ms, cal history " << historyTime
+             << " ms across them), init " << msecs(p1, p2) << " ms, wire "
+             << msecs(p2, p3) << " ms (" << sensors.size() << " cards)" << endl;
+
         if ( noneFound ) {
             ostringstream ostr;
             ostr << "No analog cards available to calibrate!";
             cout << ostr.str() << endl;
-            QMessageBox::critical(0, "no cards", ostr.str().c_str());
+            _acc->Errors().post(ERR_ERROR, "", "", "no cards", ostr.str());
             return true;
         }
         cout << "Calibrator::setup() extracted analog sensors" << endl;
@@ -212,6 +530,8 @@ bool Calibrator::setup(QString host, QString mode)
     catch (n_u::IOException& e) {
         cout << "DSM server is not running!" << endl;
         cout << "You need to start NIDAS" << endl;
+        _acc->Errors().post(ERR_ERROR, "", "", "CANNOT start",
+                            "DSM server is not running!\nYou need to start NIDAS");
         return true;
     }
     cout << "Calibrator::setup() FINISHED" << endl;
@@ -222,27 +542,62 @@ bool Calibrator::setup(QString host, QString mode)
 void Calibrator::run()
 {
     cout << "Calibrator::run()" << endl;
+    _acc->Trace().nameThread("calibrator");
 
     try {
-        _pipeline->setRealTime(true);
-        _pipeline->setProcSorterLength(0);
+        // 1. a reader thread only pulls samples off the socket and
+        //    queues them; this thread filters and analyses them.
+        _sis->addSampleClient(_ring);
+
+        if (_direct) {
+            // 2. the raw sample filter processes the samples itself
+            //    and hands them straight to the client.
+            _filter->setDirect(_acc);
+            cout << "processing raw samples directly" << endl;
+        }
+        else {
+            _pipeline->setRealTime(true);
+            _pipeline->setProcSorterLength(0);
 
-        // 2. connect the pipeline to the SampleInputStream.
-        _pipeline->connect(_sis);
+            // 2. connect the pipeline to the SampleInputStream, through
+            //    the raw sample filter.
+            _pipeline->connect(_filter);
 
-        // 3. connect the client to the pipeline
-        _pipeline->getProcessedSampleSource()->addSampleClient(_acc);
+            // 3. connect the client to the pipeline
+            _pipeline->getProcessedSampleSource()->addSampleClient(_acc);
+        }
+        // CPU the decode path uses, for comparing the direct path against
+        // the pipeline on the same archive: the whole process's, so the
+        // pipeline's sorter threads count, less the GUI's, the reader's
+        // and the fit's, which are the same either way
+        double cpu0 = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuSeconds(_guiClock);
+        double fitCpu = 0.0;
+
+        startReader();
 
         try {
             enum stateEnum state = GATHER;
+
+            // pick up where an interrupted run left off; the cards were
+            // just re-verified by setup()
+            if (_resume && !_testVoltage && _acc->LoadCheckpoint())
+                cout << "starting the calibration from the first level" << endl;
+
             while (_testVoltage) {
-                _sis->readSamples();  // see AutoCalClient::receive
+                pump();  // see AutoCalClient::receive
                 if (_canceled) {
                     cout << "Canceling diagnostics..." << endl;
                     state = DONE;
                     break;
                 }
             }
+            int remaining = -1;
+            if (!_testVoltage)
+                cout << _acc->BuildPlan();
+
+            // each iteration switches the ready cards and gathers until
+            // one of them has its level
+            Timeline::clock::time_point step = Timeline::clock::now();
             while ( (state = _acc->SetNextCalVoltage(state)) != DONE ) {
 
                 cout << "state: " << stateEnumDesc[state] << endl;
@@ -261,32 +616,74 @@ void Calibrator::run()
                         state = DONE;
                         break;
                     }
-                    _sis->readSamples();  // see AutoCalClient::receive
+                    pump();  // see AutoCalClient::receive
 
-                    // update progress bar
+                    // give up on channels that stopped producing samples
                     if (!_testVoltage)
+                        _acc->CheckStarved();
+
+                    // update progress bar
+                    if (!_testVoltage) {
                         emit setValue(_acc->progress);
+                        if (_acc->remaining != remaining)
+                            emit setRemaining(remaining = _acc->remaining);
+                    }
                 }
+                // at least one card completed its level
+                if (!_canceled)
+                    _acc->SaveCheckpoint();
+
+                _acc->Trace().add("run iteration", step);
+                step = Timeline::clock::now();
             }
             if (state == DONE) {
+                double fit0 = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuSeconds(_guiClock);
                 _acc->DisplayResults();
+                fitCpu += cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuSeconds(_guiClock) - fit0;
+
+                if (!_canceled)
+                    _acc->RemoveCheckpoint();
 
                 // update progress bar
                 emit setValue(_acc->progress);
             }
+            if (!_testVoltage) {
+                _acc->Report().finish(_canceled ? "canceled" : state == DEAD ? "dead" : "done");
+                _acc->SaveRunReport();
+            }
         }
         catch (n_u::EOFException& e) {
             cerr << e.what() << endl;
+            if (!_testVoltage) {
+                _acc->Report().finish("end of data");
+                _acc->SaveRunReport();
+            }
         }
         catch (n_u::IOException& e) {
-            _pipeline->getProcessedSampleSource()->removeSampleClient(_acc);
-            _pipeline->disconnect(_sis);
-            _sis->close();
+            detach();
             throw(e);
         }
-        _pipeline->getProcessedSampleSource()->removeSampleClient(_acc);
-        _pipeline->disconnect(_sis);
-        _sis->close();
+        detach();
+
+        double cpu = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuSeconds(_guiClock) -
+                     cpu0 - _readerCpu - fitCpu;
+        unsigned long nRaw = _filter->passed() + _filter->settling() + _filter->idle();
+
+        _filter->report();
+        _ring->report();
+        cout << _acc->Metrics().report();
+        cout << _acc->Clocks().report();
+        _acc->Control().report();
+        cout << "decode cpu: " << cpu << " seconds";
+        if (nRaw)
+            cout << ", " << cpu * 1.0e6 / nRaw << " us per raw sample";
+        cout << (_direct ? " (direct)" : " (pipeline)") << endl;
+
+        if (_canceled && _idleTime >= _cancelTime)
+            cout << "cancel to idle: " << std::chrono::duration_cast<std::chrono::milliseconds>
+                    (_idleTime - _cancelTime).count() << " ms" << endl;
+
+        _acc->Trace().write();
     }
     catch (n_u::IOException& e) {
         cerr << e.what() << endl;
@@ -298,7 +695,140 @@ void Calibrator::run()
 }
 
 
+void Calibrator::detach()
+{
+    stopReader();
+
+    if (!_direct) {
+        _pipeline->getProcessedSampleSource()->removeSampleClient(_acc);
+        _pipeline->disconnect(_filter);
+    }
+    _sis->removeSampleClient(_ring);
+    _sis->close();
+}
+
+
+void Calibrator::startReader()
+{
+    _reading = true;
+    _readerDone = false;
+    _readerError = 0;
+    _readerCpu = 0.0;
+
+    _reader = std::thread([this] {
+        _acc->Trace().nameThread("reader");
+        try {
+            while (_reading && !_canceled)
+                if (waitReadable())
+                    _sis->readSamples();  // see SampleRing::receive
+        }
+        catch (...) {
+            // handed to the analysis thread by pump()
+            _readerError = std::current_exception();
+        }
+        if (_canceled)
+            _idleTime = std::chrono::steady_clock::now();
+        _readerCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+        _readerDone = true;
+    });
+}
+
+
+bool Calibrator::waitReadable()
+{
+    // a file set may not have opened its first file yet
+    int fd = _iochan->getFd();
+    if (fd < 0) return true;
+
+    struct pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = _wakeup[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    if (::poll(fds, _wakeup[0] >= 0 ? 2 : 1, READ_TIMEOUT) <= 0)
+        return false;
+
+    if (fds[1].revents) {
+        char buf[16];
+        while (::read(_wakeup[0], buf, sizeof(buf)) > 0);
+    }
+    // let readSamples() report a hangup or error
+    return fds[0].revents != 0;
+}
+
+
+void Calibrator::wakeReader()
+{
+    if (_wakeup[1] >= 0) {
+        char c = 0;
+        if (::write(_wakeup[1], &c, 1) < 0) {
+            // already full, the reader has a wakeup pending
+        }
+    }
+}
+
+
+void Calibrator::stopReader()
+{
+    if (!_reader.joinable()) return;
+
+    _reading = false;
+    _ring->close();
+    wakeReader();
+    _reader.join();
+    _ring->clear();
+}
+
+
+void Calibrator::pump()
+{
+    // Feed a batch of queued samples through the filter, leaving the
+    // caller free to check for progress and cancellation in between.
+    bool traced = _acc->Trace().enabled();
+    Timeline::clock::time_point t0;
+    if (traced)
+        t0 = Timeline::clock::now();
+
+    // Handled no earlier than now, which errs toward a longer settle.
+    struct timeval tv;
+    ::gettimeofday(&tv, 0);
+    dsm_time_t now = (dsm_time_t)tv.tv_sec * USECS_PER_SEC + tv.tv_usec;
+
+    const Sample* samp;
+    int n;
+    for (n = 0; n < PUMP_BATCH && (samp = _ring->pop()); n++) {
+        _acc->Clocks().observe(GET_DSM_ID(samp->getId()), samp->getTimeTag(), now);
+        _filter->receive(samp);
+        samp->freeReference();
+    }
+    if (n) {
+        if (traced)
+            _acc->Trace().add("receive", t0, std::to_string(n) + " samples");
+        return;
+    }
+
+    if (_readerDone) {
+        if (_readerError)
+            std::rethrow_exception(_readerError);
+
+        // the reader stopped for a cancel; the caller notices it next
+        if (_canceled) return;
+
+        throw n_u::EOFException("sample reader", "stopped");
+    }
+    ::usleep(PUMP_WAIT);
+}
+
+
 void Calibrator::cancel()
 {
+    _cancelTime = std::chrono::steady_clock::now();
     _canceled = true;
+    wakeReader();
+
+    // abandon any XML-RPC call the run is waiting on
+    _acc->Control().cancel();
 }
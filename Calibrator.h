@@ -31,14 +31,21 @@
 #include <nidas/util/SocketAddress.h>
 #include <nidas/dynld/RawSampleInputStream.h>
 
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <exception>
 #include <map>
 #include <string>
+#include <thread>
 
 //#include <QtWidgets>
 #include <QThread>
 #include <QString>
 
 #include "AutoCalClient.h"
+#include "RawSampleFilter.h"
+#include "SampleRing.h"
 
 using namespace nidas::core;
 using namespace nidas::dynld;
@@ -62,6 +69,37 @@ public:
 
     inline void setTestVoltage() { _testVoltage = true; };
 
+    /// Continue an interrupted calibration from its checkpoint.
+    inline void setResume() { _resume = true; };
+
+    /// Process raw samples in line instead of through the SamplePipeline.
+    inline void setDirect() { _direct = true; };
+
+    /// Only print the run plan once the cards are found; apply no voltages.
+    inline void setPlanOnly() { _planOnly = true; };
+
+    inline bool planOnly() const { return _planOnly; };
+
+    /// Cache of the analog sensors in the project configuration.
+    inline void setConfigCache(const string& path) { _configCache = path; };
+
+    /// When main() started, for timing the startup.
+    inline void setLaunchTime(std::chrono::steady_clock::time_point t) { _launchTime = t; };
+
+    /// Milliseconds since main() started.
+    long sinceLaunch() const;
+
+    /**
+     * Discover the cards on a setup thread.  Each card is announced with
+     * cardDiscovered() as it is found, and the ones that fail are posted to
+     * the client's ErrorLog.  Then setupFinished() reports whether the
+     * setup failed.  cancel() ends it early.
+     */
+    void startSetup(QString host, QString mode);
+
+    /// Wait for the setup thread; call once setupFinished() has arrived.
+    void finishSetup();
+
     bool setup(QString host, QString mode);
 
     void run();
@@ -69,18 +107,90 @@ public:
 signals:
     void setValue(int progress);
 
+    /// Expected seconds left in the run, sent when it changes.
+    void setRemaining(int seconds);
+
+    void cardDiscovered(const QString& location, const QString& dsmName, unsigned int dsmId,
+                        const QString& calFile, const QString& devName, unsigned int devId);
+
+    void setupFinished(bool failed);
+
 public slots:
     void cancel();
 
 private:
+    /// Detach the filter, pipeline and client from the input stream.
+    void detach();
+
+    /// Start the thread that reads samples off the socket into _ring.
+    void startReader();
+
+    void stopReader();
+
+    /**
+     * Wait up to READ_TIMEOUT for the input stream to become readable.
+     * Returns false on a timeout or a wakeup, so the reader can look
+     * for a cancel or stop request.
+     */
+    bool waitReadable();
+
+    /// Interrupt waitReadable() through the self-pipe.
+    void wakeReader();
+
+    /**
+     * Analyse a batch of the samples queued by the reader thread.
+     * Rethrows whatever ended the reader once the ring has drained.
+     */
+    void pump();
+
     bool _testVoltage;
 
-    bool _canceled;
+    bool _resume;
+
+    bool _direct;
+
+    bool _planOnly;
+
+    string _configCache;
+
+    std::chrono::steady_clock::time_point _launchTime;
+
+    std::atomic<bool> _canceled;
+
+    /// When cancel() was called, and when the reader then stopped.
+    std::chrono::steady_clock::time_point _cancelTime;
+    std::chrono::steady_clock::time_point _idleTime;
 
     AutoCalClient* _acc;
 
     RawSampleInputStream* _sis;
 
+    RawSampleFilter* _filter;
+
+    SampleRing* _ring;
+
+    /// The input stream's channel, owned by _sis.
+    IOChannel* _iochan;
+
+    /// Self-pipe used to wake the reader out of poll().
+    int _wakeup[2];
+
+    std::thread _reader;
+
+    std::thread _setupThread;
+
+    std::atomic<bool> _reading;
+
+    std::atomic<bool> _readerDone;
+
+    std::exception_ptr _readerError;
+
+    /// CPU seconds the reader thread used, set as it ends.
+    std::atomic<double> _readerCpu;
+
+    /// The GUI thread's CPU clock.
+    clockid_t _guiClock;
+
     SamplePipeline* _pipeline;
 
     map<dsm_sample_id_t, string>dsmLocations;
@@ -0,0 +1,217 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "ChannelMetrics.h"
+
+#include <iomanip>
+#include <sstream>
+
+using std::string;
+
+namespace {
+
+/// The bin holding fraction p of the samples counted in latency.
+int percentileBin(const unsigned long* latency, double p)
+{
+    unsigned long total = 0;
+    for (int b = 0; b < LATENCY_BINS; b++)
+        total += latency[b];
+    if (total == 0)
+        return -1;
+
+    unsigned long sum = 0;
+    for (int b = 0; b < LATENCY_BINS; b++) {
+        sum += latency[b];
+        if (sum >= p * total)
+            return b;
+    }
+    return LATENCY_BINS - 1;
+}
+
+string binText(int bin)
+{
+    if (bin < 0)
+        return "-";
+
+    std::ostringstream ostr;
+    unsigned int limit = ChannelMetrics::binLimit(bin);
+    if (limit)
+        ostr << "<" << limit;
+    else
+        ostr << ">" << ChannelMetrics::binLimit(bin - 1);
+    return ostr.str();
+}
+
+}
+
+
+ChannelMetrics::Channel::Channel():
+   received(0), settling(0), afterFull(0), gaps(0), missed(0), early(0)
+{
+    for (int b = 0; b < LATENCY_BINS; b++)
+        latency[b] = 0;
+}
+
+
+ChannelMetrics::Card::Card():
+   rawSettling(0), rawIdle(0)
+{
+}
+
+
+unsigned int ChannelMetrics::binLimit(int bin)
+{
+    if (bin >= LATENCY_BINS - 1)
+        return 0;
+    return 1u << bin;
+}
+
+
+void ChannelMetrics::addCard(dsm_sample_id_t card, const string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cards[card].name = name;
+}
+
+
+void ChannelMetrics::rawDropped(dsm_sample_id_t card, bool settling)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    card_map::iterator it = _cards.find(card);
+    if (it == _cards.end())
+        return;
+    if (settling)
+        it->second.rawSettling++;
+    else
+        it->second.rawIdle++;
+}
+
+
+void ChannelMetrics::arrived(dsm_sample_id_t card, dsm_sample_id_t sampId,
+                             const std::map<unsigned int, unsigned int>& channels,
+                             unsigned int rate, dsm_time_t timeTag, dsm_time_t now,
+                             dsm_time_t since)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    card_map::iterator it = _cards.find(card);
+    if (it == _cards.end())
+        return;
+
+    // samples this one follows after, were there no gap
+    long missed = 0;
+    dsm_time_t& last = _lastTag[sampId];
+    if (rate > 0 && last >= since && last > 0) {
+        double periods = (double)(timeTag - last) * rate / USECS_PER_SEC;
+        if (periods > 1.5)
+            missed = (long)(periods + 0.5) - 1;
+    }
+    last = timeTag;
+
+    dsm_time_t latency = now - timeTag;
+    int bin = 0;
+    while (bin < LATENCY_BINS - 1 &&
+           latency >= (dsm_time_t)binLimit(bin) * USECS_PER_MSEC)
+        bin++;
+
+    std::map<unsigned int, unsigned int>::const_iterator ic;
+    for (ic = channels.begin(); ic != channels.end(); ic++) {
+        Channel& chn = it->second.channels[ic->second];
+        chn.received++;
+        if (missed) {
+            chn.gaps++;
+            chn.missed += missed;
+        }
+        if (latency < 0)
+            chn.early++;
+        chn.latency[bin]++;
+    }
+}
+
+
+void ChannelMetrics::settling(dsm_sample_id_t card,
+                              const std::map<unsigned int, unsigned int>& channels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    card_map::iterator it = _cards.find(card);
+    if (it == _cards.end())
+        return;
+
+    std::map<unsigned int, unsigned int>::const_iterator ic;
+    for (ic = channels.begin(); ic != channels.end(); ic++)
+        it->second.channels[ic->second].settling++;
+}
+
+
+void ChannelMetrics::afterFull(dsm_sample_id_t card, unsigned int chn)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    card_map::iterator it = _cards.find(card);
+    if (it != _cards.end())
+        it->second.channels[chn].afterFull++;
+}
+
+
+ChannelMetrics::card_map ChannelMetrics::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cards;
+}
+
+
+string ChannelMetrics::report() const
+{
+    card_map cards = snapshot();
+
+    std::ostringstream ostr;
+    ostr << "channel metrics (latency in ms from the time tag to receive()):\n";
+
+    card_map::const_iterator ic;
+    for (ic = cards.begin(); ic != cards.end(); ic++) {
+        const Card& card = ic->second;
+
+        ostr << card.name << ": raw samples dropped " << card.rawSettling
+             << " while settling, " << card.rawIdle << " while idle\n";
+        if (card.channels.empty())
+            continue;
+
+        ostr << std::right << std::setw(6) << "chn" << std::setw(10) << "received"
+             << std::setw(10) << "settling" << std::setw(11) << "after FULL"
+             << std::setw(7) << "gaps" << std::setw(9) << "missed"
+             << std::setw(8) << "p50" << std::setw(8) << "p99"
+             << std::setw(8) << "early" << "\n";
+
+        std::map<unsigned int, Channel>::const_iterator ik;
+        for (ik = card.channels.begin(); ik != card.channels.end(); ik++) {
+            const Channel& chn = ik->second;
+            ostr << std::setw(6) << ik->first << std::setw(10) << chn.received
+                 << std::setw(10) << chn.settling << std::setw(11) << chn.afterFull
+                 << std::setw(7) << chn.gaps << std::setw(9) << chn.missed
+                 << std::setw(8) << binText(percentileBin(chn.latency, 0.50))
+                 << std::setw(8) << binText(percentileBin(chn.latency, 0.99))
+                 << std::setw(8) << chn.early << "\n";
+        }
+    }
+    return ostr.str();
+}
@@ -0,0 +1,115 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef CHANNELMETRICS_H
+#define CHANNELMETRICS_H
+
+#include <nidas/core/DSMSensor.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+using namespace nidas::core;
+
+// sample latency histogram bins: under 1, 2, 4, ... 4096 ms, and longer
+#define LATENCY_BINS 14
+
+/**
+ * @class ChannelMetrics
+ * What each channel of each card actually delivered: how many samples
+ * came in, how many were thrown away while the card settled or after
+ * the channel was FULL, the gaps in their time tags, and how long they
+ * took from the card to receive().  Dropped data and a lagging pipeline
+ * show up here instead of as a level that never seems to fill.
+ *
+ * Counted from the thread delivering samples, and read from any other
+ * through snapshot() or report() while the run goes on.
+ */
+class ChannelMetrics
+{
+public:
+    struct Channel {
+        unsigned long received;     // samples that reached receive()
+        unsigned long settling;     // thrown away by receive() while settling
+        unsigned long afterFull;    // arrived once the channel was FULL
+        unsigned long gaps;         // time tag steps over 1.5 sample periods
+        unsigned long missed;       // samples those gaps should have held
+        unsigned long early;        // time tag ahead of the host clock
+        unsigned long latency[LATENCY_BINS];
+        Channel();
+    };
+
+    struct Card {
+        std::string name;
+        unsigned long rawSettling;  // raw samples RawSampleFilter dropped while settling
+        unsigned long rawIdle;      // ... and while the card was not gathering
+        std::map<unsigned int, Channel> channels;   // indexed by chn
+        Card();
+    };
+
+    /// Cards are indexed by AutoCalClient::id(dsmId, devId).
+    typedef std::map<dsm_sample_id_t, Card> card_map;
+
+    void addCard(dsm_sample_id_t card, const std::string& name);
+
+    /// A raw sample of card was dropped before conversion.
+    void rawDropped(dsm_sample_id_t card, bool settling);
+
+    /**
+     * Sample sampId of card, holding channels (indexed by varId), arrived
+     * at host time now.  A step in its time tags is a gap unless the
+     * sample before it came from before since, when the card was last
+     * switched and the samples in between were dropped on purpose.
+     */
+    void arrived(dsm_sample_id_t card, dsm_sample_id_t sampId,
+                 const std::map<unsigned int, unsigned int>& channels,
+                 unsigned int rate, dsm_time_t timeTag, dsm_time_t now,
+                 dsm_time_t since);
+
+    /// A sample of card was thrown away by receive() while it settled.
+    void settling(dsm_sample_id_t card,
+                  const std::map<unsigned int, unsigned int>& channels);
+
+    void afterFull(dsm_sample_id_t card, unsigned int chn);
+
+    card_map snapshot() const;
+
+    /// Table of every card's channels, with their latency percentiles.
+    std::string report() const;
+
+    /// Upper bound of bin, in milliseconds; 0 for the last, open one.
+    static unsigned int binLimit(int bin);
+
+private:
+    mutable std::mutex _mutex;
+
+    card_map _cards;
+
+    /// latest time tag of each sample id, for finding gaps
+    std::map<dsm_sample_id_t, dsm_time_t> _lastTag;
+};
+
+#endif
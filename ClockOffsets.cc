@@ -0,0 +1,129 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "ClockOffsets.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using std::string;
+
+// an offset this large means the DSM's clock is not being kept (ms)
+#define OFFSET_WARN 1000
+
+
+ClockOffsets::Estimate::Estimate():
+   samples(0), windowStart(0), current(0), previous(0),
+   havePrevious(false), lowest(0), highest(0)
+{
+}
+
+
+dsm_time_t ClockOffsets::Estimate::value() const
+{
+    if (samples == 0)
+        return 0;
+    if (havePrevious && previous < current)
+        return previous;
+    return current;
+}
+
+
+void ClockOffsets::addDsm(unsigned int dsmId, const string& name)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _dsms[dsmId].name = name;
+}
+
+
+void ClockOffsets::observe(unsigned int dsmId, dsm_time_t tag, dsm_time_t now)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<unsigned int, Estimate>::iterator it = _dsms.find(dsmId);
+    if (it == _dsms.end())
+        return;
+
+    Estimate& e = it->second;
+    dsm_time_t offset = now - tag;
+
+    if (e.samples++ == 0) {
+        e.windowStart = now;
+        e.current = offset;
+        e.lowest = e.highest = offset;
+        std::cout << "ClockOffsets: " << e.name << " is " << offset / USECS_PER_MSEC
+                  << " ms behind the host" << std::endl;
+        return;
+    }
+    if (now - e.windowStart > OFFSET_WINDOW * USECS_PER_SEC) {
+        e.previous = e.current;
+        e.havePrevious = true;
+        e.current = offset;
+        e.windowStart = now;
+    }
+    else if (offset < e.current)
+        e.current = offset;
+
+    dsm_time_t v = e.value();
+    if (v < e.lowest) e.lowest = v;
+    if (v > e.highest) e.highest = v;
+}
+
+
+dsm_time_t ClockOffsets::offset(unsigned int dsmId) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<unsigned int, Estimate>::const_iterator it = _dsms.find(dsmId);
+    if (it == _dsms.end())
+        return 0;
+    return it->second.value();
+}
+
+
+string ClockOffsets::report() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::ostringstream ostr;
+    ostr << "clock offsets (ms the DSM clock is behind the host, sample transit included):\n";
+
+    std::map<unsigned int, Estimate>::const_iterator it;
+    for (it = _dsms.begin(); it != _dsms.end(); it++) {
+        const Estimate& e = it->second;
+        ostr << std::left << std::setw(12) << e.name << std::right;
+        if (e.samples == 0) {
+            ostr << "  no samples\n";
+            continue;
+        }
+        dsm_time_t v = e.value();
+        ostr << std::setw(10) << v / USECS_PER_MSEC
+             << "  ranged " << e.lowest / USECS_PER_MSEC << " to "
+             << e.highest / USECS_PER_MSEC << " over " << e.samples << " samples";
+        if (v > OFFSET_WARN * USECS_PER_MSEC || v < -OFFSET_WARN * USECS_PER_MSEC)
+            ostr << "  (clock not kept?)";
+        ostr << "\n";
+    }
+    return ostr.str();
+}
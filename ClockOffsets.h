@@ -0,0 +1,89 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef CLOCKOFFSETS_H
+#define CLOCKOFFSETS_H
+
+#include <nidas/core/DSMSensor.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+using namespace nidas::core;
+
+// seconds of samples each running minimum covers
+#define OFFSET_WINDOW 30
+
+/**
+ * @class ClockOffsets
+ * How far each DSM's clock is behind the host's, so that a card's settle
+ * window can be put in the time base of its sample time tags.
+ *
+ * Every raw sample gives the host time it was handled less its DSM time
+ * tag, which is the clock offset plus however long the sample took to get
+ * here.  The least of those over the last OFFSET_WINDOW to 2 *
+ * OFFSET_WINDOW seconds is the estimate: it follows a drifting or
+ * stepped clock, and it is off only by the quickest a sample ever gets
+ * through, which is well under the settle time.
+ */
+class ClockOffsets
+{
+public:
+    void addDsm(unsigned int dsmId, const std::string& name);
+
+    /// A raw sample from dsmId, time tagged tag, handled at host time now.
+    void observe(unsigned int dsmId, dsm_time_t tag, dsm_time_t now);
+
+    /**
+     * Host time less DSM time for dsmId, in microseconds; 0 until its
+     * first sample, which leaves the settle windows in host time.
+     */
+    dsm_time_t offset(unsigned int dsmId) const;
+
+    /// The current estimate for each DSM, and how far it moved over the run.
+    std::string report() const;
+
+private:
+    struct Estimate {
+        std::string name;
+        unsigned long samples;
+        dsm_time_t windowStart;    // host time the current window began
+        dsm_time_t current;        // least offset in the current window
+        dsm_time_t previous;       // ... and in the one before
+        bool havePrevious;
+        dsm_time_t lowest;         // range of the estimate over the run
+        dsm_time_t highest;
+        Estimate();
+        dsm_time_t value() const;
+    };
+
+    mutable std::mutex _mutex;
+
+    /// indexed by dsmId
+    std::map<unsigned int, Estimate> _dsms;
+};
+
+#endif
@@ -0,0 +1,255 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "ConfigCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace xercesc;
+
+namespace {
+
+const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+const unsigned long long FNV_PRIME  = 1099511628211ULL;
+
+unsigned long long fnv(unsigned long long h, const XMLCh* s)
+{
+    if (s)
+        for ( ; *s; ++s) {
+            h = (h ^ (*s & 0xff)) * FNV_PRIME;
+            h = (h ^ (*s >> 8)) * FNV_PRIME;
+        }
+    // separate adjacent strings, so "ab","c" and "a","bc" differ
+    return (h ^ 0xff) * FNV_PRIME;
+}
+
+unsigned long long hashNode(unsigned long long h, const DOMNode* node)
+{
+    h = (h ^ node->getNodeType()) * FNV_PRIME;
+    h = fnv(h, node->getNodeName());
+    h = fnv(h, node->getNodeValue());
+
+    const DOMNamedNodeMap* attrs = node->getAttributes();
+    if (attrs)
+        for (unsigned long i = 0; i < attrs->getLength(); i++) {
+            h = fnv(h, attrs->item(i)->getNodeName());
+            h = fnv(h, attrs->item(i)->getNodeValue());
+        }
+
+    for (const DOMNode* child = node->getFirstChild(); child;
+         child = child->getNextSibling())
+        h = hashNode(h, child);
+    return h;
+}
+
+std::string str(const XMLCh* s)
+{
+    if (!s) return "";
+    char* c = XMLString::transcode(s);
+    std::string result(c);
+    XMLString::release(&c);
+    return result;
+}
+
+std::string attribute(const DOMElement* elem, const char* name)
+{
+    XMLCh* xname = XMLString::transcode(name);
+    std::string value = str(elem->getAttribute(xname));
+    XMLString::release(&xname);
+    return value;
+}
+
+}
+
+
+ConfigCache::ConfigCache(const std::string& path):
+   _path(path)
+{
+}
+
+
+unsigned long long ConfigCache::Hash(const DOMNode* node)
+{
+    return node ? hashNode(FNV_OFFSET, node) : FNV_OFFSET;
+}
+
+
+bool ConfigCache::IsAnalog(const std::string& className)
+{
+    return className == "raf.DSMAnalogSensor" ||       // ncar_a2d
+           className == "DSC_A2DSensor" ||             // Diamond - ddmat
+           className == "raf.A2D_Serial";              // gpDAQ
+}
+
+
+bool ConfigCache::load(const std::string& server, unsigned long long hash)
+{
+    _analog.clear();
+    if (_path.empty())
+        return false;
+
+    std::ifstream in(_path.c_str());
+    if (!in)
+        return false;
+
+    std::string line, key, cachedServer;
+    unsigned long long cachedHash = 0;
+    bool haveHash = false;
+
+    while (std::getline(in, line)) {
+        std::istringstream ist(line);
+        if (!(ist >> key))
+            continue;
+
+        if (key == "server")
+            ist >> cachedServer;
+        else if (key == "hash")
+            haveHash = (bool)(ist >> std::hex >> cachedHash);
+        else if (key == "dsm") {
+            std::string dsmName, devName;
+            if (!(ist >> dsmName))
+                continue;
+            std::set<std::string>& devs = _analog[dsmName];
+            while (ist >> devName)
+                devs.insert(devName);
+        }
+    }
+    if (!haveHash || cachedServer != server || cachedHash != hash) {
+        _analog.clear();
+        return false;
+    }
+    return true;
+}
+
+
+bool ConfigCache::save(const std::string& server, unsigned long long hash) const
+{
+    if (_path.empty())
+        return false;
+
+    // write beside the old cache and rename, so a crash leaves one or the other
+    std::string tmp = _path + ".tmp";
+    std::ofstream out(tmp.c_str());
+    if (!out) {
+        std::cout << "ConfigCache: cannot write " << tmp << std::endl;
+        return false;
+    }
+    out << "server " << server << "\n";
+    out << "hash " << std::hex << hash << std::dec << "\n";
+
+    std::map<std::string, std::set<std::string> >::const_iterator di;
+    for (di = _analog.begin(); di != _analog.end(); ++di) {
+        out << "dsm " << di->first;
+        std::set<std::string>::const_iterator si;
+        for (si = di->second.begin(); si != di->second.end(); ++si)
+            out << " " << *si;
+        out << "\n";
+    }
+    out.close();
+    if (!out || ::rename(tmp.c_str(), _path.c_str())) {
+        std::cout << "ConfigCache: cannot write " << _path << std::endl;
+        ::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+void ConfigCache::invalidate()
+{
+    _analog.clear();
+    if (!_path.empty())
+        ::remove(_path.c_str());
+}
+
+
+void ConfigCache::add(const std::string& dsmName, const std::string& deviceName)
+{
+    std::set<std::string>& devs = _analog[dsmName];
+    if (!deviceName.empty())
+        devs.insert(deviceName);
+}
+
+
+unsigned int ConfigCache::prune(DOMNode* node) const
+{
+    unsigned int removed = 0;
+
+    for ( ; node; node = node->getNextSibling()) {
+        if (node->getNodeType() != DOMNode::ELEMENT_NODE)
+            continue;
+
+        const DOMElement* elem = static_cast<const DOMElement*>(node);
+        if (str(elem->getTagName()) != "dsm") {
+            removed += prune(node->getFirstChild());
+            continue;
+        }
+
+        // a DSM that is not in the cache keeps all of its sensors
+        std::map<std::string, std::set<std::string> >::const_iterator di =
+            _analog.find(attribute(elem, "name"));
+        if (di == _analog.end())
+            continue;
+
+        DOMNode* child = node->getFirstChild();
+        while (child) {
+            DOMNode* next = child->getNextSibling();
+            if (child->getNodeType() == DOMNode::ELEMENT_NODE) {
+                const DOMElement* sensor = static_cast<const DOMElement*>(child);
+                std::string devName = attribute(sensor, "devicename");
+
+                // sensor, serialSensor, arincSensor, ...
+                if (str(sensor->getTagName()).find("ensor") != std::string::npos &&
+                    !devName.empty() && !di->second.count(devName)) {
+                    node->removeChild(child)->release();
+                    removed++;
+                }
+            }
+            child = next;
+        }
+    }
+    return removed;
+}
+
+
+size_t ConfigCache::count(const std::string& dsmName) const
+{
+    std::map<std::string, std::set<std::string> >::const_iterator di =
+        _analog.find(dsmName);
+    return di == _analog.end() ? 0 : di->second.size();
+}
+
+
+size_t ConfigCache::size() const
+{
+    size_t n = 0;
+    std::map<std::string, std::set<std::string> >::const_iterator di;
+    for (di = _analog.begin(); di != _analog.end(); ++di)
+        n += di->second.size();
+    return n;
+}
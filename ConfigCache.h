@@ -0,0 +1,90 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef CONFIGCACHE_H
+#define CONFIGCACHE_H
+
+#include <xercesc/dom/DOM.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+
+/**
+ * @class ConfigCache
+ * Remembers which sensors of the project XML configuration are analog
+ * cards, keyed by the dsm_server host and a hash of the configuration.
+ * When the server hands out the same configuration again, every other
+ * sensor element is pruned from the DOM before Project::fromDOMElement()
+ * so that only the analog cards are built.
+ *
+ * The file holds one "server", one "hash", and one "dsm" line per DSM
+ * listing the device names of its analog sensors.
+ */
+class ConfigCache
+{
+public:
+    ConfigCache(const std::string& path);
+
+    /// FNV-1a hash over the names, attributes and text of a DOM tree.
+    static unsigned long long Hash(const xercesc::DOMNode* node);
+
+    /// Sensor classes that auto_cal knows how to talk to.
+    static bool IsAnalog(const std::string& className);
+
+    /// Read the cache; returns true if it matches this server and hash.
+    bool load(const std::string& server, unsigned long long hash);
+
+    bool save(const std::string& server, unsigned long long hash) const;
+
+    /// Remove the cache file, so that the next launch does a full parse.
+    void invalidate();
+
+    /**
+     * Record an analog sensor of a DSM.  An empty device name just records
+     * the DSM, so that all of its sensors are pruned on the next launch.
+     */
+    void add(const std::string& dsmName, const std::string& deviceName = "");
+
+    /**
+     * Remove the sensor elements of the cached DSMs whose device names are
+     * not in the cache.  Elements without a devicename attribute, such as
+     * references into the sensor catalog, are kept.  Returns the number
+     * of elements removed.
+     */
+    unsigned int prune(xercesc::DOMNode* node) const;
+
+    /// Number of analog sensors cached for a DSM.
+    size_t count(const std::string& dsmName) const;
+
+    size_t size() const;
+
+private:
+    std::string _path;
+
+    std::map<std::string, std::set<std::string> > _analog;
+};
+
+#endif
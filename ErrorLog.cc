@@ -0,0 +1,161 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "ErrorLog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+const char* ErrorLog::describe(enum errSeverity severity)
+{
+    switch (severity) {
+    case ERR_INFO:    return "notice";
+    case ERR_WARNING: return "warning";
+    case ERR_ERROR:   return "error";
+    }
+    return "unknown";
+}
+
+
+void ErrorLog::post(enum errSeverity severity, const std::string& dsm,
+                    const std::string& card, const std::string& title,
+                    const std::string& reason)
+{
+    Entry entry;
+    entry.severity = severity;
+    entry.dsm = dsm;
+    entry.card = card;
+    entry.title = title;
+    entry.reason = reason;
+    entry.when = ::time(0);
+
+    std::cout << describe(severity) << ": " << title;
+    if (!dsm.empty())
+        std::cout << " (" << dsm << (card.empty() ? "" : ":") << card << ")";
+    std::cout << std::endl << reason << std::endl;
+
+    std::string reportFile;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.push_back(entry);
+        reportFile = _reportFile;
+    }
+    if (!reportFile.empty()) {
+        std::lock_guard<std::mutex> lock(_fileMutex);
+        write(reportFile);
+    }
+    emit posted();
+}
+
+
+std::vector<ErrorLog::Entry> ErrorLog::entries() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries;
+}
+
+
+size_t ErrorLog::count(enum errSeverity severity) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t n = 0;
+    for (size_t i = 0; i < _entries.size(); i++)
+        if (_entries[i].severity == severity)
+            n++;
+    return n;
+}
+
+
+size_t ErrorLog::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+
+void ErrorLog::setReportFile(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _reportFile = path;
+    }
+    if (!path.empty()) {
+        std::lock_guard<std::mutex> lock(_fileMutex);
+        write(path);
+    }
+}
+
+
+std::string ErrorLog::report() const
+{
+    std::vector<Entry> all = entries();
+
+    std::ostringstream ostr;
+    ostr << "auto_cal problems: " << count(ERR_ERROR) << " errors, "
+         << count(ERR_WARNING) << " warnings, " << count(ERR_INFO) << " notices\n";
+
+    for (size_t i = 0; i < all.size(); i++) {
+        const Entry& e = all[i];
+        char when[32];
+        struct tm tm;
+        ::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", ::localtime_r(&e.when, &tm));
+
+        ostr << "\n" << when << "  " << describe(e.severity) << "  ";
+        if (!e.dsm.empty())
+            ostr << e.dsm << (e.card.empty() ? "" : ":") << e.card << "  ";
+        ostr << e.title << "\n";
+
+        // indent the reason under its heading
+        std::istringstream ist(e.reason);
+        std::string line;
+        while (std::getline(ist, line))
+            if (!line.empty())
+                ostr << "    " << line << "\n";
+    }
+    return ostr.str();
+}
+
+
+bool ErrorLog::write(const std::string& path) const
+{
+    // write beside the old report and rename, so a reader never sees half of one
+    std::string tmp = path + ".tmp";
+    std::ofstream out(tmp.c_str());
+    if (!out) {
+        std::cout << "ErrorLog: cannot write " << tmp << std::endl;
+        return false;
+    }
+    out << report();
+    out.close();
+    if (!out || ::rename(tmp.c_str(), path.c_str())) {
+        std::cout << "ErrorLog: cannot write " << path << std::endl;
+        ::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
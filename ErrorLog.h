@@ -0,0 +1,95 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef ERRORLOG_H
+#define ERRORLOG_H
+
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QObject>
+
+enum errSeverity { ERR_INFO, ERR_WARNING, ERR_ERROR };
+
+/**
+ * @class ErrorLog
+ * Collects the problems found while discovering, calibrating and saving
+ * the cards.  Any thread may post() without blocking on the operator;
+ * ErrorReport shows the collection, and with a report file set it is
+ * rewritten there after every post for runs with nobody watching.
+ */
+class ErrorLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        enum errSeverity severity;
+        std::string dsm;               // empty when not about one DSM
+        std::string card;              // device name, empty when not about one card
+        std::string title;
+        std::string reason;
+        time_t when;
+    };
+
+    static const char* describe(enum errSeverity severity);
+
+    void post(enum errSeverity severity, const std::string& dsm,
+              const std::string& card, const std::string& title,
+              const std::string& reason);
+
+    /// A copy of everything posted so far, oldest first.
+    std::vector<Entry> entries() const;
+
+    size_t count(enum errSeverity severity) const;
+
+    size_t size() const;
+
+    /// Write the report to path after every post, starting with an empty one.
+    void setReportFile(const std::string& path);
+
+    /// Plain text report of everything posted so far.
+    std::string report() const;
+
+    bool write(const std::string& path) const;
+
+signals:
+    /// Queued to the GUI when posted from another thread.
+    void posted();
+
+private:
+    mutable std::mutex _mutex;
+
+    /// Keeps posts from several threads from writing the report at once.
+    std::mutex _fileMutex;
+
+    std::vector<Entry> _entries;
+
+    std::string _reportFile;
+};
+
+#endif
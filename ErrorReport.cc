@@ -0,0 +1,143 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "ErrorReport.h"
+
+#include <QBoxLayout>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+using std::vector;
+
+
+ErrorReport::ErrorReport(ErrorLog* log, QWidget* parent)
+    : QDialog(parent), _log(log), _seen(0)
+{
+    setWindowTitle(tr("Auto Calibration Problems"));
+    setModal(false);
+    resize(900, 400);
+
+    // index is the least severe problem listed
+    _severity = new QComboBox;
+    _severity->addItem(tr("Everything"));
+    _severity->addItem(tr("Warnings and errors"));
+    _severity->addItem(tr("Errors only"));
+
+    _filter = new QLineEdit;
+    _filter->setPlaceholderText(tr("Filter by DSM, card or text"));
+
+    _summary = new QLabel;
+
+    _list = new QTreeWidget;
+    _list->setRootIsDecorated(false);
+    _list->setHeaderLabels(QStringList() << tr("Time") << tr("Severity") << tr("DSM")
+                                         << tr("Card") << tr("Problem") << tr("Reason"));
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+
+    QHBoxLayout* filters = new QHBoxLayout;
+    filters->addWidget(_severity);
+    filters->addWidget(_filter);
+
+    QVBoxLayout* layout = new QVBoxLayout;
+    layout->addLayout(filters);
+    layout->addWidget(_summary);
+    layout->addWidget(_list);
+    layout->addWidget(buttons);
+    setLayout(layout);
+
+    connect(_severity, SIGNAL(currentIndexChanged(int)),     this, SLOT(refresh()));
+    connect(_filter,   SIGNAL(textChanged(const QString&)),  this, SLOT(refresh()));
+    connect(buttons,   SIGNAL(rejected()),                   this, SLOT(hide()));
+
+    // posts from other threads are queued to this one
+    connect(_log,      SIGNAL(posted()),                     this, SLOT(posted()));
+}
+
+
+void ErrorReport::posted()
+{
+    vector<ErrorLog::Entry> entries = _log->entries();
+
+    bool alarming = false;
+    for (size_t i = _seen; i < entries.size(); i++)
+        if (entries[i].severity != ERR_INFO)
+            alarming = true;
+
+    refresh();
+
+    if (alarming && !isVisible())
+        show();
+}
+
+
+void ErrorReport::refresh()
+{
+    vector<ErrorLog::Entry> entries = _log->entries();
+    _seen = entries.size();
+
+    enum errSeverity least = (enum errSeverity)_severity->currentIndex();
+    QString text = _filter->text();
+
+    _list->clear();
+    for (size_t i = 0; i < entries.size(); i++) {
+        const ErrorLog::Entry& e = entries[i];
+        if (e.severity < least)
+            continue;
+
+        QString dsm    = QString::fromStdString(e.dsm);
+        QString card   = QString::fromStdString(e.card);
+        QString title  = QString::fromStdString(e.title);
+        QString reason = QString::fromStdString(e.reason);
+
+        if (!text.isEmpty() &&
+            !dsm.contains(text, Qt::CaseInsensitive) &&
+            !card.contains(text, Qt::CaseInsensitive) &&
+            !title.contains(text, Qt::CaseInsensitive) &&
+            !reason.contains(text, Qt::CaseInsensitive))
+            continue;
+
+        char when[16];
+        struct tm tm;
+        ::strftime(when, sizeof(when), "%H:%M:%S", ::localtime_r(&e.when, &tm));
+
+        QTreeWidgetItem* item = new QTreeWidgetItem(QStringList()
+            << when << ErrorLog::describe(e.severity) << dsm << card << title
+            << reason.simplified());
+        item->setToolTip(5, reason);
+        _list->addTopLevelItem(item);
+    }
+    for (int col = 0; col < 5; col++)
+        _list->resizeColumnToContents(col);
+
+    _summary->setText(tr("%1 errors, %2 warnings, %3 notices")
+                      .arg((int)_log->count(ERR_ERROR))
+                      .arg((int)_log->count(ERR_WARNING))
+                      .arg((int)_log->count(ERR_INFO)));
+}
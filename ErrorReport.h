@@ -0,0 +1,76 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef ERRORREPORT_H
+#define ERRORREPORT_H
+
+#include <QDialog>
+
+#include "ErrorLog.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+/**
+ * @class ErrorReport
+ * One window listing everything posted to an ErrorLog, filtered by
+ * severity and by text.  It is not modal and pops up by itself when a
+ * new warning or error arrives, so a run never waits on the operator.
+ */
+class ErrorReport : public QDialog
+{
+    Q_OBJECT
+
+public:
+    ErrorReport(ErrorLog* log, QWidget* parent = 0);
+
+public slots:
+    /// Rebuild the list from the log with the current filters.
+    void refresh();
+
+private slots:
+    void posted();
+
+private:
+    ErrorLog* _log;
+
+    /// Least severe problem listed.
+    QComboBox* _severity;
+
+    QLineEdit* _filter;
+
+    QLabel* _summary;
+
+    QTreeWidget* _list;
+
+    /// How many entries had been posted at the last refresh.
+    size_t _seen;
+};
+
+#endif
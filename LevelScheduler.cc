@@ -0,0 +1,145 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "LevelScheduler.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const char* orderNames[] = { "ascending", "common", "swing", "fastest" };
+
+/// Sorts the levels needed by more cards first, then the smaller ones.
+struct ByCommon {
+    const std::map<int, unsigned int>& cards;
+    ByCommon(const std::map<int, unsigned int>& c): cards(c) {}
+    bool operator()(int a, int b) const {
+        unsigned int na = cards.find(a)->second;
+        unsigned int nb = cards.find(b)->second;
+        if (na != nb) return na > nb;
+        if (std::abs(a) != std::abs(b)) return std::abs(a) < std::abs(b);
+        return a > b;
+    }
+};
+
+/**
+ * The shortest path in volts through levels from 0 V: out to the nearer
+ * extreme and back across to the other, each side in order.
+ */
+vector<int> shortestSwing(const std::set<int>& levels)
+{
+    vector<int> up, down;
+    std::set<int>::const_iterator il;
+    for (il = levels.begin(); il != levels.end(); il++)
+        if (*il >= 0)
+            up.push_back(*il);
+    std::set<int>::const_reverse_iterator ir;
+    for (ir = levels.rbegin(); ir != levels.rend(); ir++)
+        if (*ir < 0)
+            down.push_back(*ir);
+
+    vector<int> order;
+    int hi = up.empty() ? 0 : up.back();
+    int lo = down.empty() ? 0 : down.back();
+    if (hi <= -lo) {
+        order = up;
+        order.insert(order.end(), down.begin(), down.end());
+    }
+    else {
+        order = down;
+        // crossing back over 0 V, the non-negative levels come up from the bottom
+        order.insert(order.end(), up.begin(), up.end());
+    }
+    return order;
+}
+
+}
+
+
+const char* LevelScheduler::describe(enum levelOrder order)
+{
+    return orderNames[order];
+}
+
+
+bool LevelScheduler::parse(const string& name, enum levelOrder& order)
+{
+    for (int i = ORDER_ASCENDING; i <= ORDER_FASTEST; i++)
+        if (name == orderNames[i]) {
+            order = (enum levelOrder) i;
+            return true;
+        }
+    return false;
+}
+
+
+LevelScheduler::level_orders LevelScheduler::Order(const level_sets& sets, enum levelOrder order)
+{
+    // how many cards need each level
+    std::map<int, unsigned int> cards;
+    level_sets::const_iterator is;
+    std::set<int>::const_iterator il;
+    for (is = sets.begin(); is != sets.end(); is++)
+        for (il = is->second.begin(); il != is->second.end(); il++)
+            cards[*il]++;
+
+    level_orders orders;
+    for (is = sets.begin(); is != sets.end(); is++) {
+        vector<int>& levels = orders[is->first];
+
+        switch (order) {
+        case ORDER_ASCENDING:
+            levels.assign(is->second.begin(), is->second.end());
+            break;
+        case ORDER_SWING:
+            levels = shortestSwing(is->second);
+            break;
+        default:
+            levels.assign(is->second.begin(), is->second.end());
+            std::stable_sort(levels.begin(), levels.end(), ByCommon(cards));
+            break;
+        }
+    }
+    return orders;
+}
+
+
+double LevelScheduler::Swing(const level_orders& orders)
+{
+    double volts = 0.0;
+    level_orders::const_iterator io;
+    for (io = orders.begin(); io != orders.end(); io++) {
+        int at = 0;
+        for (size_t i = 0; i < io->second.size(); i++) {
+            volts += std::abs(io->second[i] - at);
+            at = io->second[i];
+        }
+    }
+    return volts;
+}
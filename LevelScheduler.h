@@ -0,0 +1,71 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef LEVELSCHEDULER_H
+#define LEVELSCHEDULER_H
+
+#include <nidas/core/DSMSensor.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace nidas::core;
+
+enum levelOrder { ORDER_ASCENDING, ORDER_COMMON, ORDER_SWING, ORDER_FASTEST };
+
+/**
+ * @class LevelScheduler
+ * Orders the voltage levels each card steps through.
+ *
+ *  ascending  lowest level first, as calActv is keyed
+ *  common     the levels most cards need first, so the cards of a DSM
+ *             stay on the same level and switch in one request
+ *  swing      each card takes the shortest path in volts from 0 V
+ *  fastest    whichever of those RunPlanner::simulate() finishes first
+ *
+ * Every card still visits each of its levels exactly once.
+ */
+class LevelScheduler
+{
+public:
+    /// Levels of each card, indexed by AutoCalClient::id(dsmId, devId).
+    typedef std::map<dsm_sample_id_t, std::set<int> > level_sets;
+
+    typedef std::map<dsm_sample_id_t, std::vector<int> > level_orders;
+
+    static const char* describe(enum levelOrder order);
+
+    static bool parse(const std::string& name, enum levelOrder& order);
+
+    /// ORDER_FASTEST needs a simulation, so it is ordered as ORDER_COMMON here.
+    static level_orders Order(const level_sets& sets, enum levelOrder order);
+
+    /// Volts stepped through by all of the cards, starting from 0 V.
+    static double Swing(const level_orders& orders);
+};
+
+#endif
@@ -31,7 +31,7 @@
 namespace numeric
 {
 
-inline double PolyEval(double *cof, unsigned int order, double target)
+inline double PolyEval(const double *cof, unsigned int order, double target)
 {
   if (order == 0)
     return 0.0;
@@ -46,9 +46,9 @@ inline double PolyEval(double *cof, unsigned int order, double target)
   return out;
 }
 
-inline double PolyEval(std::vector<double> cof, double target)
+inline double PolyEval(const std::vector<double>& cof, double target)
 {
-  return PolyEval(&cof[0], cof.size(), target);
+  return PolyEval(cof.data(), cof.size(), target);
 }
 
 }
@@ -0,0 +1,101 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "RawSampleFilter.h"
+
+#include <iostream>
+#include <list>
+
+RawSampleFilter::RawSampleFilter(const AutoCalClient* acc, ChannelMetrics* metrics):
+   SampleSourceSupport(true),
+   _acc(acc),
+   _metrics(metrics),
+   _client(0),
+   _passed(0),
+   _settling(0),
+   _idle(0)
+{
+}
+
+
+bool RawSampleFilter::receive(const Sample* samp) throw()
+{
+    dsm_sample_id_t rawId = samp->getId();
+
+    switch (_acc->RawFate(rawId, samp->getTimeTag())) {
+    case RAW_SETTLING:
+        _settling++;
+        if (_metrics)
+            _metrics->rawDropped(_acc->id(GET_DSM_ID(rawId), GET_SPS_ID(rawId)), true);
+        return false;
+    case RAW_IDLE:
+        _idle++;
+        if (_metrics)
+            _metrics->rawDropped(_acc->id(GET_DSM_ID(rawId), GET_SPS_ID(rawId)), false);
+        return false;
+    default:
+        break;
+    }
+    _passed++;
+
+    if (!_client) {
+        distribute(samp);
+        return true;
+    }
+    std::map<dsm_sample_id_t, DSMSensor*>::const_iterator iS = _sensors.find(samp->getId());
+    if (iS == _sensors.end())
+        return false;
+
+    std::list<const Sample*> results;
+    iS->second->process(samp, results);
+
+    std::list<const Sample*>::const_iterator iR;
+    for (iR = results.begin(); iR != results.end(); iR++) {
+        _client->receive(*iR);
+        (*iR)->freeReference();
+    }
+    return true;
+}
+
+
+void RawSampleFilter::addSensor(DSMSensor* sensor)
+{
+    _sensors[sensor->getId()] = sensor;
+}
+
+
+void RawSampleFilter::report() const
+{
+    unsigned long total = _passed + _settling + _idle;
+
+    std::cout << "raw filter: " << total << " samples, "
+              << _passed << " passed, "
+              << _settling << " dropped while settling, "
+              << _idle << " dropped from idle cards";
+    if (total)
+        std::cout << " (" << 100 * (_settling + _idle) / total
+                  << "% of conversions avoided)";
+    std::cout << std::endl;
+}
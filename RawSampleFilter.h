@@ -0,0 +1,93 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef RAWSAMPLEFILTER_H
+#define RAWSAMPLEFILTER_H
+
+#include <nidas/core/DSMSensor.h>
+#include <nidas/core/SampleClient.h>
+#include <nidas/core/SampleSourceSupport.h>
+
+#include <map>
+
+#include "AutoCalClient.h"
+
+using namespace nidas::core;
+
+/**
+ * @class RawSampleFilter
+ * Sits between the RawSampleInputStream and the SamplePipeline, and
+ * drops raw samples that AutoCalClient::receive() would throw away
+ * anyway, before the pipeline sorts and converts them.  Samples from
+ * cards that are still settling, or that are not gathering, are
+ * counted and discarded.
+ *
+ * In direct mode the samples that pass are handed straight to their
+ * sensor's process() and the results to a single client, bypassing the
+ * pipeline's sorters and threads altogether.
+ */
+class RawSampleFilter : public SampleClient, public SampleSourceSupport
+{
+public:
+    /// Drops are counted per card in metrics, when there is one.
+    RawSampleFilter(const AutoCalClient* acc, ChannelMetrics* metrics = 0);
+
+    bool receive(const Sample* samp) throw();
+
+    void flush() throw() { SampleSourceSupport::flush(); };
+
+    /// Register a sensor whose raw samples direct mode processes.
+    void addSensor(DSMSensor* sensor);
+
+    /// Process samples in line and deliver the results to client.
+    void setDirect(SampleClient* client) { _client = client; };
+
+    /// Print how many samples were passed and dropped.
+    void report() const;
+
+    unsigned long passed() const { return _passed; };
+
+    unsigned long settling() const { return _settling; };
+
+    unsigned long idle() const { return _idle; };
+
+private:
+    const AutoCalClient* _acc;
+
+    ChannelMetrics* _metrics;
+
+    SampleClient* _client;
+
+    /// _sensors[raw sample id]
+    std::map<dsm_sample_id_t, DSMSensor*> _sensors;
+
+    unsigned long _passed;
+
+    unsigned long _settling;
+
+    unsigned long _idle;
+};
+
+#endif
@@ -0,0 +1,169 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef _numeric_RobustFilter_h_
+#define _numeric_RobustFilter_h_
+
+#include <algorithm>
+#include <cmath>
+
+namespace numeric
+{
+
+/**
+ * Streaming outlier rejection for a nominally constant signal, such as an
+ * A2D channel sitting on an internal calibration voltage.
+ *
+ * The filter keeps the last WINDOW accepted values.  A new value is
+ * rejected when it lies more than nMad scaled median absolute deviations
+ * from their median.  The scale is held above floor so that a very quiet
+ * channel does not reject its own noise.  Values that are not finite are
+ * always rejected, and counted apart from the outliers: many of them mean
+ * the channel is out of range rather than glitching.
+ *
+ * RESEED rejects in a row that agree with each other mean the window, not
+ * the values, is wrong (it was seeded before the signal settled), so the
+ * window restarts from them and they are taken back: see recovered().  A
+ * burst of spikes that scatter does not reseed it.
+ */
+class RobustFilter
+{
+public:
+  enum { WINDOW = 15, MIN_SAMPLES = 5, RESEED = 5 };
+
+  RobustFilter(double nMad = 5.0, double floor = 0.01) :
+    _n(0), _next(0), _rejected(0), _nonFinite(0), _run(0), _recovered(0),
+    _nMad(nMad), _floor(floor) {}
+
+  /// Returns true if x should be kept.
+  bool accept(float x)
+  {
+    _recovered = 0;
+    if (!std::isfinite(x)) {
+      _nonFinite++;
+      return false;
+    }
+
+    if (_n >= MIN_SAMPLES) {
+      float work[WINDOW];
+      std::copy(_window, _window + _n, work);
+      float median = middle(work, _n);
+
+      for (unsigned int i = 0; i < _n; i++)
+        work[i] = std::fabs(_window[i] - median);
+      double scale = std::max(1.4826 * middle(work, _n), _floor);
+
+      if (std::fabs(x - median) > _nMad * scale) {
+        // keep the latest RESEED values of the run
+        if (_run == RESEED) {
+          std::copy(_recent + 1, _recent + RESEED, _recent);
+          _run--;
+        }
+        _recent[_run++] = x;
+        if (_run < RESEED || !agree(_recent, RESEED, _nMad * scale)) {
+          _rejected++;
+          return false;
+        }
+        // take back the rejects before x, and restart the window from them
+        _rejected -= RESEED - 1;
+        _recovered = RESEED - 1;
+        _n = _next = 0;
+        for (unsigned int i = 0; i < RESEED - 1; i++)
+          push(_recent[i]);
+        // and x itself, below
+      }
+    }
+    _run = 0;
+    push(x);
+
+    return true;
+  }
+
+  /// Number of values rejected so far.
+  unsigned int rejected() const { return _rejected; }
+
+  /// Number of NaN or infinite values seen so far.
+  unsigned int nonFinite() const { return _nonFinite; }
+
+  /**
+   * Values rejected earlier that the last accept() took back when it
+   * reseeded the window, oldest first; keep them before its own value.
+   */
+  unsigned int recovered() const { return _recovered; }
+
+  const float* recoveredValues() const { return _recent; }
+
+private:
+  void push(float x)
+  {
+    _window[_next] = x;
+    _next = (_next + 1) % WINDOW;
+    if (_n < WINDOW)
+      _n++;
+  }
+
+  /// True if all n values of v lie within tolerance of their median.
+  static bool agree(const float *v, unsigned int n, double tolerance)
+  {
+    float work[RESEED];
+    std::copy(v, v + n, work);
+    float median = middle(work, n);
+    for (unsigned int i = 0; i < n; i++)
+      if (std::fabs(v[i] - median) > tolerance)
+        return false;
+    return true;
+  }
+
+  static float middle(float *v, unsigned int n)
+  {
+    std::nth_element(v, v + n/2, v + n);
+    return v[n/2];
+  }
+
+  float _window[WINDOW];
+
+  unsigned int _n;
+
+  unsigned int _next;
+
+  unsigned int _rejected;
+
+  unsigned int _nonFinite;
+
+  /// rejects in a row, and their values
+  unsigned int _run;
+
+  float _recent[RESEED];
+
+  unsigned int _recovered;
+
+  double _nMad;
+
+  double _floor;
+};
+
+}
+
+#endif
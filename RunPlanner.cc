@@ -0,0 +1,267 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "RunPlanner.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using std::string;
+
+// switch time assumed for a DSM with no answered XML-RPC calls (seconds)
+#define DEFAULT_SWITCH 0.5
+
+// weight of the newest observation in the learned estimates
+#define LEARN_WEIGHT 0.5
+
+namespace {
+
+string duration(double seconds)
+{
+    long s = (long)(seconds + 0.5);
+    std::ostringstream ostr;
+    if (s >= 3600)
+        ostr << s / 3600 << "h" << std::setw(2) << std::setfill('0') << s / 60 % 60 << "m";
+    else if (s >= 60)
+        ostr << s / 60 << "m" << std::setw(2) << std::setfill('0') << s % 60 << "s";
+    else
+        ostr << s << "s";
+    return ostr.str();
+}
+
+}
+
+
+RunPlanner::RunPlanner():
+   _settle(0.0),
+   _samples(0)
+{
+}
+
+
+void RunPlanner::clear()
+{
+    _cards.clear();
+    _switch.clear();
+}
+
+
+void RunPlanner::addCard(dsm_sample_id_t card, const string& name,
+                         const string& dsm, const std::vector<Level>& levels)
+{
+    Card& c = _cards[card];
+    c.name = name;
+    c.dsm = dsm;
+    c.levels = levels;
+    c.factor = 1.0;
+    c.observed = 0;
+}
+
+
+void RunPlanner::setSwitch(const string& dsm, double seconds)
+{
+    _switch[dsm] = seconds;
+}
+
+
+void RunPlanner::observeSwitch(const string& dsm, double seconds)
+{
+    std::map<string, double>::iterator it = _switch.find(dsm);
+    if (it == _switch.end())
+        _switch[dsm] = seconds;
+    else
+        it->second += LEARN_WEIGHT * (seconds - it->second);
+}
+
+
+double RunPlanner::switchSeconds(const string& dsm) const
+{
+    std::map<string, double>::const_iterator is = _switch.find(dsm);
+    return is == _switch.end() ? DEFAULT_SWITCH : is->second;
+}
+
+
+double RunPlanner::gatherSeconds(dsm_sample_id_t card, size_t i) const
+{
+    std::map<dsm_sample_id_t, Card>::const_iterator it = _cards.find(card);
+    if (it == _cards.end() || i >= it->second.levels.size())
+        return 0.0;
+    double rate = it->second.levels[i].rate;
+    return rate > 0.0 ? _samples / rate : 0.0;
+}
+
+
+double RunPlanner::levelSeconds(dsm_sample_id_t card, size_t i) const
+{
+    std::map<dsm_sample_id_t, Card>::const_iterator it = _cards.find(card);
+    if (it == _cards.end() || i >= it->second.levels.size())
+        return 0.0;
+    return it->second.factor * (_settle + gatherSeconds(card, i));
+}
+
+
+double RunPlanner::stepSeconds(dsm_sample_id_t card, size_t i) const
+{
+    std::map<dsm_sample_id_t, Card>::const_iterator it = _cards.find(card);
+    if (it == _cards.end() || i >= it->second.levels.size())
+        return 0.0;
+
+    return switchSeconds(it->second.dsm) + levelSeconds(card, i);
+}
+
+
+double RunPlanner::remainingSeconds(dsm_sample_id_t card, size_t i) const
+{
+    std::map<dsm_sample_id_t, Card>::const_iterator it = _cards.find(card);
+    if (it == _cards.end())
+        return 0.0;
+
+    double seconds = 0.0;
+    for ( ; i < it->second.levels.size(); i++)
+        seconds += stepSeconds(card, i);
+    return seconds;
+}
+
+
+void RunPlanner::observe(dsm_sample_id_t card, size_t i, double seconds)
+{
+    std::map<dsm_sample_id_t, Card>::iterator it = _cards.find(card);
+    if (it == _cards.end() || i >= it->second.levels.size())
+        return;
+
+    Card& c = it->second;
+    double expected = _settle + gatherSeconds(card, i);
+    if (expected <= 0.0)
+        return;
+
+    double ratio = seconds / expected;
+    if (c.observed++ == 0)
+        c.factor = ratio;
+    else
+        c.factor += LEARN_WEIGHT * (ratio - c.factor);
+}
+
+
+double RunPlanner::totalSeconds() const
+{
+    double total = 0.0;
+    std::map<dsm_sample_id_t, Card>::const_iterator it;
+    for (it = _cards.begin(); it != _cards.end(); it++)
+        total = std::max(total, remainingSeconds(it->first, 0));
+    return total;
+}
+
+
+RunPlanner::Projection RunPlanner::simulate() const
+{
+    struct State {
+        size_t next;
+        bool active;
+        double gathered;    // when the current level will be
+    };
+    std::map<dsm_sample_id_t, State> states;
+    std::map<dsm_sample_id_t, Card>::const_iterator it;
+    for (it = _cards.begin(); it != _cards.end(); it++) {
+        State s = { 0, false, 0.0 };
+        states[it->first] = s;
+    }
+
+    Projection p = { 0.0, 0 };
+    double t = 0.0;
+    for (;;) {
+        // the ready cards of each DSM, switched together
+        std::map<string, std::vector<dsm_sample_id_t> > ready;
+        for (it = _cards.begin(); it != _cards.end(); it++) {
+            const State& s = states[it->first];
+            if (s.next <= it->second.levels.size() && (!s.active || s.gathered <= t))
+                ready[it->second.dsm].push_back(it->first);
+        }
+        std::map<string, std::vector<dsm_sample_id_t> >::const_iterator ir;
+        for (ir = ready.begin(); ir != ready.end(); ir++) {
+            t += switchSeconds(ir->first);
+            p.requests++;
+            for (size_t k = 0; k < ir->second.size(); k++) {
+                State& s = states[ir->second[k]];
+                s.active = s.next < _cards.find(ir->second[k])->second.levels.size();
+                if (s.active)
+                    s.gathered = t + levelSeconds(ir->second[k], s.next);
+                s.next++;     // past the end, the card was left open
+            }
+        }
+
+        // on to whichever card gathers next
+        double first = -1.0;
+        std::map<dsm_sample_id_t, State>::const_iterator is;
+        for (is = states.begin(); is != states.end(); is++)
+            if (is->second.active && (first < 0.0 || is->second.gathered < first))
+                first = is->second.gathered;
+        if (first < 0.0)
+            break;
+        t = std::max(t, first);
+
+        // gathered cards wait for the next step
+        std::map<dsm_sample_id_t, State>::iterator iw;
+        for (iw = states.begin(); iw != states.end(); iw++)
+            if (iw->second.active && iw->second.gathered <= t)
+                iw->second.active = false;
+    }
+    p.seconds = t;
+    return p;
+}
+
+
+string RunPlanner::plan() const
+{
+    std::ostringstream ostr;
+    ostr << "run plan: " << _cards.size() << " cards, settle " << _settle
+         << " s, " << _samples << " samples per level\n";
+
+    double total = 0.0;
+    string slowest;
+
+    std::map<dsm_sample_id_t, Card>::const_iterator it;
+    for (it = _cards.begin(); it != _cards.end(); it++) {
+        const Card& c = it->second;
+        double card = remainingSeconds(it->first, 0);
+
+        ostr << std::left << std::setw(24) << c.name << std::right
+             << std::setw(8) << duration(card) << " ";
+        for (size_t i = 0; i < c.levels.size(); i++)
+            ostr << " " << c.levels[i].level << "v@" << c.levels[i].rate
+                 << "sps=" << duration(stepSeconds(it->first, i));
+        ostr << "\n";
+
+        if (card > total) {
+            total = card;
+            slowest = c.name;
+        }
+    }
+    ostr << "expected duration " << duration(total);
+    if (!slowest.empty())
+        ostr << ", set by " << slowest;
+    ostr << "\n";
+    return ostr.str();
+}
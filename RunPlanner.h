@@ -0,0 +1,131 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef RUNPLANNER_H
+#define RUNPLANNER_H
+
+#include <nidas/core/DSMSensor.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace nidas::core;
+
+/**
+ * @class RunPlanner
+ * Expected duration of each card's levels: switching the voltage (the
+ * XML-RPC round trip of its DSM), the settle, and gathering NSAMPS from
+ * the slowest channel in use at that level.  The cards step through
+ * their levels independently, so the run takes as long as its slowest
+ * card.
+ *
+ * As levels complete it learns, per card, how the actual level times
+ * compare with the expected ones, and scales that card's remaining
+ * levels to match.  Used from the thread that steps the sequences only.
+ */
+class RunPlanner
+{
+public:
+    struct Level {
+        int level;
+        double rate;        // sps of the slowest channel in use at level
+    };
+
+    RunPlanner();
+
+    void clear();
+
+    void setSettle(double seconds) { _settle = seconds; };
+
+    void setSamples(unsigned int n) { _samples = n; };
+
+    /// Cards are indexed by AutoCalClient::id(dsmId, devId).
+    void addCard(dsm_sample_id_t card, const std::string& name,
+                 const std::string& dsm, const std::vector<Level>& levels);
+
+    /// Expected XML-RPC round trip to switch the cards of dsm.
+    void setSwitch(const std::string& dsm, double seconds);
+
+    double switchSeconds(const std::string& dsm) const;
+
+    /// Fold in a round trip to dsm that was just measured.
+    void observeSwitch(const std::string& dsm, double seconds);
+
+    double gatherSeconds(dsm_sample_id_t card, size_t i) const;
+
+    /// Settle and gather of the card's i'th level, scaled by what it has learned.
+    double levelSeconds(dsm_sample_id_t card, size_t i) const;
+
+    /// The switch of the card's DSM, then levelSeconds().
+    double stepSeconds(dsm_sample_id_t card, size_t i) const;
+
+    /// Steps from the card's i'th level to its last.
+    double remainingSeconds(dsm_sample_id_t card, size_t i) const;
+
+    /// The card's i'th level took seconds from its switch to gathered.
+    void observe(dsm_sample_id_t card, size_t i, double seconds);
+
+    /// Expected duration of the whole run.
+    double totalSeconds() const;
+
+    struct Projection {
+        double seconds;
+        unsigned long requests;     // voltage switch requests, one per DSM per step
+    };
+
+    /**
+     * Step the cards the way SetNextCalVoltage() does: whenever a card
+     * has gathered, every ready card is switched, one request per DSM
+     * and one DSM after another.  Unlike totalSeconds(), this counts
+     * the cards of a DSM that fall out of step and need requests of
+     * their own.
+     */
+    Projection simulate() const;
+
+    /// Table of each card's levels and expected times, for a dry run.
+    std::string plan() const;
+
+private:
+    struct Card {
+        std::string name;
+        std::string dsm;
+        std::vector<Level> levels;
+        double factor;      // actual over expected level time
+        unsigned int observed;
+    };
+
+    double _settle;
+
+    unsigned int _samples;
+
+    /// indexed by card id
+    std::map<dsm_sample_id_t, Card> _cards;
+
+    /// switch seconds, indexed by DSM name
+    std::map<std::string, double> _switch;
+};
+
+#endif
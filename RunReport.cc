@@ -0,0 +1,268 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "RunReport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using std::string;
+
+// keys listed under each phase of the summary
+#define SUMMARY_KEYS 3
+
+namespace {
+
+string jsonString(const string& s)
+{
+    std::ostringstream ostr;
+    ostr << '"';
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+            ostr << '\\' << c;
+        else if (c < 0x20)
+            ostr << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                 << std::dec << std::setfill(' ');
+        else
+            ostr << c;
+    }
+    ostr << '"';
+    return ostr.str();
+}
+
+string format(time_t t, const char* fmt)
+{
+    char buf[32];
+    struct tm tm;
+    ::strftime(buf, sizeof(buf), fmt, ::localtime_r(&t, &tm));
+    return buf;
+}
+
+bool writeFile(const string& path, const string& text)
+{
+    string tmp = path + ".tmp";
+    std::ofstream out(tmp.c_str());
+    if (out)
+        out << text;
+    out.close();
+    if (!out || ::rename(tmp.c_str(), path.c_str())) {
+        std::cout << "RunReport: cannot write " << path << std::endl;
+        ::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
+
+
+RunReport::Timer::Timer(RunReport& report, const string& phase, const string& key):
+   _report(report), _phase(phase), _key(key), _start(clock::now())
+{
+}
+
+
+RunReport::Timer::~Timer()
+{
+    _report.add(_phase, _key, _start);
+}
+
+
+void RunReport::Stat::add(double seconds)
+{
+    if (count == 0 || seconds < min) min = seconds;
+    if (count == 0 || seconds > max) max = seconds;
+    total += seconds;
+    count++;
+}
+
+
+RunReport::RunReport():
+   _startTime(::time(0)),
+   _start(clock::now()),
+   _finished(false),
+   _cards(0)
+{
+}
+
+
+void RunReport::add(const string& phase, const string& key, double seconds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::map<string, Phase>::iterator it = _phases.find(phase);
+    if (it == _phases.end()) {
+        _order.push_back(phase);
+        it = _phases.insert(make_pair(phase, Phase())).first;
+    }
+    it->second.all.add(seconds);
+    if (!key.empty())
+        it->second.keys[key].add(seconds);
+}
+
+
+void RunReport::add(const string& phase, const string& key, clock::time_point since)
+{
+    add(phase, key, std::chrono::duration<double>(clock::now() - since).count());
+}
+
+
+void RunReport::setCards(size_t cards)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cards = cards;
+}
+
+
+void RunReport::finish(const string& outcome)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _outcome = outcome;
+    _finish = clock::now();
+    _finished = true;
+}
+
+
+double RunReport::wallSeconds() const
+{
+    clock::time_point end = _finished ? _finish : clock::now();
+    return std::chrono::duration<double>(end - _start).count();
+}
+
+
+string RunReport::json() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::ostringstream ostr;
+    ostr << std::fixed << std::setprecision(6);
+    ostr << "{\n";
+    ostr << "  \"started\": " << jsonString(format(_startTime, "%Y-%m-%dT%H:%M:%S")) << ",\n";
+    ostr << "  \"outcome\": " << jsonString(_outcome) << ",\n";
+    ostr << "  \"wall_seconds\": " << wallSeconds() << ",\n";
+    ostr << "  \"cards\": " << _cards << ",\n";
+    ostr << "  \"phases\": [";
+
+    for (size_t i = 0; i < _order.size(); i++) {
+        const Phase& phase = _phases.find(_order[i])->second;
+        const Stat& s = phase.all;
+
+        ostr << (i ? "," : "") << "\n    {\n";
+        ostr << "      \"phase\": " << jsonString(_order[i]) << ",\n";
+        ostr << "      \"count\": " << s.count << ",\n";
+        ostr << "      \"total_seconds\": " << s.total << ",\n";
+        ostr << "      \"min_seconds\": " << s.min << ",\n";
+        ostr << "      \"max_seconds\": " << s.max << ",\n";
+        ostr << "      \"mean_seconds\": " << s.total / std::max(s.count, 1ul) << ",\n";
+        ostr << "      \"keys\": {";
+
+        std::map<string, Stat>::const_iterator ik;
+        for (ik = phase.keys.begin(); ik != phase.keys.end(); ik++) {
+            const Stat& k = ik->second;
+            ostr << (ik == phase.keys.begin() ? "" : ",") << "\n        "
+                 << jsonString(ik->first) << ": { \"count\": " << k.count
+                 << ", \"total_seconds\": " << k.total
+                 << ", \"min_seconds\": " << k.min
+                 << ", \"max_seconds\": " << k.max << " }";
+        }
+        ostr << (phase.keys.empty() ? "}\n" : "\n      }\n") << "    }";
+    }
+    ostr << "\n  ]\n}\n";
+    return ostr.str();
+}
+
+
+string RunReport::summary() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    double wall = wallSeconds();
+
+    std::ostringstream ostr;
+    ostr << "auto_cal run started " << format(_startTime, "%Y-%m-%d %H:%M:%S")
+         << ", " << (_outcome.empty() ? "unfinished" : _outcome.c_str())
+         << " after " << std::fixed << std::setprecision(1) << wall << " s, "
+         << _cards << " cards\n\n";
+
+    ostr << std::left << std::setw(16) << "phase" << std::right
+         << std::setw(7) << "count" << std::setw(11) << "total s"
+         << std::setw(10) << "mean s" << std::setw(10) << "max s"
+         << std::setw(9) << "of wall" << "\n";
+
+    for (size_t i = 0; i < _order.size(); i++) {
+        const Phase& phase = _phases.find(_order[i])->second;
+        const Stat& s = phase.all;
+
+        ostr << std::left << std::setw(16) << _order[i] << std::right
+             << std::setw(7) << s.count << std::setprecision(3)
+             << std::setw(11) << s.total
+             << std::setw(10) << s.total / std::max(s.count, 1ul)
+             << std::setw(10) << s.max << std::setprecision(1)
+             << std::setw(8) << (wall > 0.0 ? 100.0 * s.total / wall : 0.0) << "%\n";
+
+        if (phase.keys.size() < 2)
+            continue;
+
+        // the keys that took the longest
+        std::vector<std::pair<double, string> > worst;
+        std::map<string, Stat>::const_iterator ik;
+        for (ik = phase.keys.begin(); ik != phase.keys.end(); ik++)
+            worst.push_back(std::make_pair(ik->second.total, ik->first));
+        std::sort(worst.rbegin(), worst.rend());
+
+        ostr << "    slowest:";
+        for (size_t k = 0; k < worst.size() && k < SUMMARY_KEYS; k++)
+            ostr << (k ? "," : "") << " " << worst[k].second
+                 << " (" << std::setprecision(3) << worst[k].first << " s)";
+        ostr << "\n";
+    }
+    ostr << "\nProbe, CalFile read and per card fit times overlap across threads,\n"
+            "so those totals can exceed their share of the wall time.\n";
+    return ostr.str();
+}
+
+
+bool RunReport::save(const std::set<string>& dirs) const
+{
+    string base = "auto_cal_run_" + format(_startTime, "%Y%m%d_%H%M%S");
+    string text = summary();
+    string data = json();
+
+    bool ok = !dirs.empty();
+    std::set<string>::const_iterator id;
+    for (id = dirs.begin(); id != dirs.end(); id++) {
+        string path = *id + "/" + base;
+        ok = writeFile(path + ".json", data) && ok;
+        ok = writeFile(path + ".txt", text) && ok;
+        std::cout << "RunReport: wrote " << path << ".{json,txt}" << std::endl;
+    }
+    std::cout << text;
+    return ok;
+}
@@ -0,0 +1,125 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef RUNREPORT_H
+#define RUNREPORT_H
+
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @class RunReport
+ * Where the time of a calibration run went.  Each phase (config fetch,
+ * probe, voltage switch, settle, gather, fit, ...) keeps a count and the
+ * total, shortest and longest times spent in it, overall and for each
+ * key within it (a card, a DSM, a level).  Times come from the steady
+ * clock.  Adding one costs a clock read and a short lock, so it is
+ * done per card or per level, never per sample.
+ *
+ * At the end of a run it is written as JSON for comparing runs over
+ * time, and as a plain text summary.
+ */
+class RunReport
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Adds the time from its construction to its destruction.
+    class Timer
+    {
+    public:
+        Timer(RunReport& report, const std::string& phase, const std::string& key = "");
+        ~Timer();
+
+    private:
+        RunReport& _report;
+        std::string _phase;
+        std::string _key;
+        clock::time_point _start;
+    };
+
+    RunReport();
+
+    void add(const std::string& phase, const std::string& key, double seconds);
+
+    /// Add the time from since until now.
+    void add(const std::string& phase, const std::string& key, clock::time_point since);
+
+    void setCards(size_t cards);
+
+    /// Note how the run ended ("done", "canceled", "dead") and when.
+    void finish(const std::string& outcome);
+
+    std::string json() const;
+
+    std::string summary() const;
+
+    /**
+     * Write auto_cal_run_<start time>.json and .txt into each directory.
+     * The names stay the same for the whole run, so a later save (after
+     * the results are saved, say) replaces the earlier one.
+     */
+    bool save(const std::set<std::string>& dirs) const;
+
+private:
+    struct Stat {
+        unsigned long count;
+        double total;
+        double min;
+        double max;
+        Stat(): count(0), total(0.0), min(0.0), max(0.0) {}
+        void add(double seconds);
+    };
+
+    struct Phase {
+        Stat all;
+        std::map<std::string, Stat> keys;
+    };
+
+    double wallSeconds() const;
+
+    mutable std::mutex _mutex;
+
+    /// phases in the order they were first seen
+    std::vector<std::string> _order;
+
+    std::map<std::string, Phase> _phases;
+
+    time_t _startTime;
+    clock::time_point _start;
+    clock::time_point _finish;
+    bool _finished;
+
+    std::string _outcome;
+
+    size_t _cards;
+};
+
+#endif
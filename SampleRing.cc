@@ -0,0 +1,109 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "SampleRing.h"
+
+#include <iostream>
+#include <unistd.h>
+
+// how long the reader sleeps while waiting for room (microseconds)
+#define RING_WAIT 1000
+
+SampleRing::SampleRing(size_t capacity):
+   _mask(0),
+   _head(0),
+   _tail(0),
+   _closed(false),
+   _highWater(0),
+   _overruns(0),
+   _pushed(0)
+{
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+    _slots.resize(n);
+    _mask = n - 1;
+}
+
+
+SampleRing::~SampleRing()
+{
+    clear();
+}
+
+
+bool SampleRing::receive(const Sample* samp) throw()
+{
+    size_t tail = _tail.load(std::memory_order_relaxed);
+
+    if (tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+        _overruns++;
+        while (tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+            if (_closed) return false;
+            ::usleep(RING_WAIT);
+        }
+    }
+    if (_closed) return false;
+
+    samp->holdReference();
+    _slots[tail & _mask] = samp;
+    _tail.store(tail + 1, std::memory_order_release);
+
+    size_t used = tail + 1 - _head.load(std::memory_order_acquire);
+    if (used > _highWater)
+        _highWater = used;
+    _pushed++;
+
+    return true;
+}
+
+
+const Sample* SampleRing::pop()
+{
+    size_t head = _head.load(std::memory_order_relaxed);
+
+    if (head == _tail.load(std::memory_order_acquire))
+        return 0;
+
+    const Sample* samp = _slots[head & _mask];
+    _head.store(head + 1, std::memory_order_release);
+
+    return samp;
+}
+
+
+void SampleRing::clear()
+{
+    const Sample* samp;
+    while ((samp = pop()))
+        samp->freeReference();
+}
+
+
+void SampleRing::report() const
+{
+    std::cout << "sample ring: " << _pushed << " samples queued, high-water "
+              << _highWater << " of " << _slots.size()
+              << ", reader waited on a full ring " << _overruns << " times" << std::endl;
+}
@@ -0,0 +1,99 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <nidas/core/SampleClient.h>
+
+#include <atomic>
+#include <vector>
+
+using namespace nidas::core;
+
+/**
+ * @class SampleRing
+ * Bounded single producer, single consumer queue of raw samples, from
+ * the thread reading the dsm_server socket to the thread analysing them.
+ * Neither side takes a lock.  When the ring is full the reader waits for
+ * room, which in turn holds back the socket, rather than dropping data.
+ */
+class SampleRing : public SampleClient
+{
+public:
+    /// capacity is rounded up to a power of two.
+    SampleRing(size_t capacity);
+
+    ~SampleRing();
+
+    /// Producer side: queue a sample, waiting while the ring is full.
+    bool receive(const Sample* samp) throw();
+
+    void flush() throw() {};
+
+    /// Consumer side: the oldest sample, or 0 if the ring is empty.
+    /// The caller owns the returned reference.
+    const Sample* pop();
+
+    /// Release a producer waiting on a full ring, and refuse new samples.
+    void close() { _closed = true; };
+
+    /// Drop whatever is still queued.
+    void clear();
+
+    size_t capacity() const { return _slots.size(); };
+
+    /// Most samples ever queued at once.
+    size_t highWater() const { return _highWater; };
+
+    /// Number of times the reader found the ring full and had to wait.
+    unsigned long overruns() const { return _overruns; };
+
+    unsigned long pushed() const { return _pushed; };
+
+    /// Print the ring's counters.
+    void report() const;
+
+private:
+    std::vector<const Sample*> _slots;
+
+    size_t _mask;
+
+    /// next slot to pop, written only by the consumer
+    std::atomic<size_t> _head;
+
+    /// next slot to push, written only by the producer
+    std::atomic<size_t> _tail;
+
+    std::atomic<bool> _closed;
+
+    std::atomic<size_t> _highWater;
+
+    std::atomic<unsigned long> _overruns;
+
+    std::atomic<unsigned long> _pushed;
+};
+
+#endif
@@ -36,6 +36,7 @@
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QLabel>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QTextStream>
 #include <QTreeView>
@@ -44,7 +45,7 @@
 /* ---------------------------------------------------------------------------------------------- */
 
 TestA2DPage::TestA2DPage(Calibrator *calib, AutoCalClient *acc, QWidget *parent)
-    : QWizardPage(parent), dsmId(-1), devId(-1), calibrator(calib), acc(acc)
+    : QWizardPage(parent), dsmId(-1), devId(-1), calibrator(calib), acc(acc), discovery(0)
 {
     setTitle(tr("Test A2Ds"));
     setSubTitle(tr("Select a card from the tree to list channels."));
@@ -56,8 +57,8 @@ TestA2DPage::TestA2DPage(Calibrator *calib, AutoCalClient *acc, QWidget *parent)
 TestA2DPage::~TestA2DPage()
 {
     cout << "TestA2DPage::~TestA2DPage()" << endl;
-    list<int> voltageLevels = acc->GetVoltageLevels();
-    list<int>::iterator l;
+    const VoltagePlans::Plan& voltageLevels = acc->GetVoltageLevels();
+    const int* l;
 
     for (int chn = 0; chn < numA2DChannels; chn++)
         for ( l = voltageLevels.begin(); l != voltageLevels.end(); l++)
@@ -70,28 +71,34 @@ void TestA2DPage::createTree()
     cout << "TestA2DPage::createTree" << endl;
     treeView = new QTreeView();
 
-    // extract the tree from AutoCalClient.
-    cout << acc->GetTreeModel();
-    treeModel = new TreeModel( QString(acc->GetTreeModel().c_str()) );
+    // starts out empty, cardDiscovered() fills it in.
+    treeModel = new TreeModel( QString() );
 
     // Initialize the QTreeView
     treeView->setModel(treeModel);
-    treeView->expandAll();
     treeView->setMinimumWidth(300);
-    treeView->resizeColumnToContents(0);
-    treeView->resizeColumnToContents(1);
-    treeView->resizeColumnToContents(2);
 
     // The dsmId(s) and devId(s) are hidden in the 3rd column.
 //  treeView->hideColumn(2);
+}
 
-    connect(treeView->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
-                                    this, SLOT(selectionChanged(const QItemSelection&, const QItemSelection&)));
+
+void TestA2DPage::cardDiscovered(const QString& location, const QString& dsmName, unsigned int dsmId,
+                                 const QString& calFile, const QString& devName, unsigned int devId)
+{
+    Timeline::Span span(acc->Trace(), "cardDiscovered");
+    treeModel->addCard(location, dsmName, dsmId, calFile, devName, devId);
+    treeView->expandAll();
+    treeView->resizeColumnToContents(0);
+    treeView->resizeColumnToContents(1);
+    treeView->resizeColumnToContents(2);
 }
 
 
 void TestA2DPage::dispVolts()
 {
+    Timeline::Span span(acc->Trace(), "dispVolts");
+
     if (devId == -1) return;
     if (dsmId == -1) return;
     if (dsmId == devId) return;
@@ -100,7 +107,7 @@ void TestA2DPage::dispVolts()
         if ( acc->calActv[0][dsmId][devId][chn] == SKIP ) continue;
 
         // obtain current set of calibration coefficients for this channel
-        std::vector<double> _cals = acc->GetOldCals(dsmId, devId, chn);
+        const std::vector<double>& _cals = acc->GetOldCals(dsmId, devId, chn);
 
         // apply the coefficients to the raw measured values
         QString raw, mes;
@@ -118,6 +125,7 @@ void TestA2DPage::dispVolts()
 void TestA2DPage::updateSelection()
 {
     cout << "TestA2DPage::updateSelection" << endl;
+    Timeline::Span span(acc->Trace(), "updateSelection");
     a2d_setup setup = acc->GetA2dSetup(dsmId, devId);
 
     for (int chn = 0; chn < numA2DChannels; chn++) {
@@ -129,20 +137,18 @@ void TestA2DPage::updateSelection()
         RawVolt[chn]->setHidden(false);
         MesVolt[chn]->setHidden(false);
 
-        list<int> voltageLevels;
-        list<int>::iterator l;
+        const int* l;
 
         // hide and uncheck all voltage selection buttons for this channel
-        voltageLevels = acc->GetVoltageLevels();
-        for ( l = voltageLevels.begin(); l != voltageLevels.end(); l++) {
+        const VoltagePlans::Plan& allLevels = acc->GetVoltageLevels();
+        for ( l = allLevels.begin(); l != allLevels.end(); l++) {
             vLvlBtn[*l][chn]->setHidden(true);
             vLvlBtn[*l][chn]->setDown(false);
 //          cout << "TestA2DPage::updateSelection vLvlBtn[" << *l << "][" << chn << "]->setDown(false);" << endl;
         }
-        voltageLevels.clear();
 
         // show available voltage selection buttons for this channel
-        voltageLevels = acc->GetVoltageLevels(dsmId, devId, chn);
+        const VoltagePlans::Plan& voltageLevels = acc->GetVoltageLevels(dsmId, devId, chn);
         if (!voltageLevels.empty()) {
             for ( l = voltageLevels.begin(); l != voltageLevels.end(); l++)
                 vLvlBtn[*l][chn]->setHidden(false);
@@ -178,9 +184,8 @@ void TestA2DPage::selectionChanged(const QItemSelection &selected, const QItemSe
         if (parent == QModelIndex()) {
 
             // DSM selected not card... hide the displayed table contents.
-            list<int> voltageLevels;
-            list<int>::iterator l;
-            voltageLevels = acc->GetVoltageLevels();
+            const VoltagePlans::Plan& voltageLevels = acc->GetVoltageLevels();
+            const int* l;
             for (int chn = 0; chn < numA2DChannels; chn++) {
                 VarName[chn]->setHidden(true);
                 RawVolt[chn]->setHidden(true);
@@ -227,7 +232,7 @@ void TestA2DPage::createGrid()
 
     layout->setColumnMinimumWidth(0, 20);
 
-    list<int> voltageLevels = acc->GetVoltageLevels();
+    const VoltagePlans::Plan& voltageLevels = acc->GetVoltageLevels();
 
     for (int chn = 0; chn < numA2DChannels; chn++) {
         Channel[chn] = new QLabel( QString("%1:").arg(chn) );
@@ -257,7 +262,7 @@ void TestA2DPage::createGrid()
         vLvlBtn[ 10][chn] = new QPushButton("10v");
         vLvlBtn[-10][chn] = new QPushButton("-10v");
 
-        list<int>::iterator l;
+        const int* l;
         int column = 4;
         for ( l = voltageLevels.begin(); l != voltageLevels.end(); l++) {
 
@@ -279,8 +284,8 @@ void TestA2DPage::createGrid()
 
 void TestA2DPage::TestVoltage()
 {
-    list<int> voltageLevels = acc->GetVoltageLevels();
-    list<int>::iterator l;
+    const VoltagePlans::Plan& voltageLevels = acc->GetVoltageLevels();
+    const int* l;
 
     for (int chn = 0; chn < numA2DChannels; chn++)
         for ( l = voltageLevels.begin(); l != voltageLevels.end(); l++)
@@ -300,12 +305,56 @@ void TestA2DPage::initializePage()
     calibrator->setTestVoltage();
     acc->setTestVoltage(-1, -1);
 
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    if (calibrator->setup("acserver", "diag")) return;
+    createTree();
+
+    mainLayout = new QHBoxLayout;
+    mainLayout->addWidget(treeView);
+
+    setLayout(mainLayout);
+
+    // The cards are discovered on the Calibrator's setup thread, so these
+    // are all Qt::QueuedConnection(s).
+    connect(calibrator, SIGNAL(cardDiscovered(const QString&, const QString&, unsigned int,
+                                              const QString&, const QString&, unsigned int)),
+            this,         SLOT(cardDiscovered(const QString&, const QString&, unsigned int,
+                                              const QString&, const QString&, unsigned int)));
+
+    connect(calibrator, SIGNAL(setupFinished(bool)),
+            this,         SLOT(setupFinished(bool)));
+
+    discovery = new QProgressDialog(tr("Searching the DSMs for analog cards..."),
+                                    tr("Cancel"), 0, 0, this);
+    discovery->setWindowTitle(tr("Discovering..."));
+    discovery->setWindowModality(Qt::WindowModal);
+
+    connect(discovery,  SIGNAL(canceled()),
+            calibrator,   SLOT(cancel()) );
+
+    discovery->show();
+
+    QApplication::setOverrideCursor(QCursor(Qt::BusyCursor));
+    calibrator->startSetup("acserver", "diag");
+}
+
+
+void TestA2DPage::setupFinished(bool failed)
+{
+    calibrator->finishSetup();
+
+    discovery->hide();
+    discovery->deleteLater();
+    discovery = 0;
+
     QApplication::restoreOverrideCursor();
+    if (failed) return;
+
+    cout << "launch to card tree: " << calibrator->sinceLaunch() << " ms" << endl;
 
-    createTree();
     createGrid();
+    mainLayout->addWidget(gridGroupBox);
+
+    connect(treeView->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
+                                    this, SLOT(selectionChanged(const QItemSelection&, const QItemSelection&)));
 
     treeView->setCurrentIndex(treeView->model()->index(0,0));
 
@@ -322,11 +371,5 @@ void TestA2DPage::initializePage()
     connect(calibrator, SIGNAL(setValue(int)),
             this,         SLOT(paint()) );
 */
-    mainLayout = new QHBoxLayout;
-    mainLayout->addWidget(treeView);
-    mainLayout->addWidget(gridGroupBox);
-
-    setLayout(mainLayout);
-
     calibrator->start();  // see Calibrator::run
 }
@@ -48,6 +48,7 @@ class QCheckBox;
 class QGridLayout;
 class QGroupBox;
 class QLabel;
+class QProgressDialog;
 class QPushButton;
 class QRadioButton;
 class QTreeView;
@@ -77,6 +78,11 @@ public slots:
     void TestVoltage();
     void updateSelection();
 
+private slots:
+    void cardDiscovered(const QString& location, const QString& dsmName, unsigned int dsmId,
+                        const QString& calFile, const QString& devName, unsigned int devId);
+    void setupFinished(bool failed);
+
 private:
     int dsmId;
     int devId;
@@ -96,6 +102,9 @@ private:
     QButtonGroup *buttonGroup;
     QHBoxLayout *mainLayout;
 
+    /// Busy indicator with a Cancel button while the cards are discovered.
+    QProgressDialog *discovery;
+
     enum { numA2DChannels = 16 };
 
     QLabel *ChannelTitle;
@@ -0,0 +1,190 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "Timeline.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using std::string;
+
+// most events kept, under 100 MB; a longer run keeps its start
+#define TIMELINE_EVENTS 1000000
+
+namespace {
+
+string jsonString(const string& s)
+{
+    std::ostringstream ostr;
+    ostr << '"';
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+            ostr << '\\' << c;
+        else if (c < 0x20)
+            ostr << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+                 << std::dec << std::setfill(' ');
+        else
+            ostr << c;
+    }
+    ostr << '"';
+    return ostr.str();
+}
+
+}
+
+
+Timeline::Span::Span(Timeline& timeline, const char* name, const string& detail):
+   _timeline(timeline), _name(name), _enabled(timeline.enabled())
+{
+    if (!_enabled) return;
+    _detail = detail;
+    _start = clock::now();
+}
+
+
+Timeline::Span::~Span()
+{
+    if (_enabled)
+        _timeline.add(_name, _start, _detail);
+}
+
+
+Timeline::Timeline():
+   _enabled(false),
+   _start(clock::now()),
+   _nextTid(0),
+   _dropped(0)
+{
+}
+
+
+void Timeline::setFile(const string& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _file = path;
+    _enabled = !path.empty();
+}
+
+
+unsigned int Timeline::tid()
+{
+    // there is only the one timeline, so one number per thread will do
+    static thread_local unsigned int mine = 0;
+    if (mine == 0)
+        mine = ++_nextTid;
+    return mine;
+}
+
+
+void Timeline::push(const Event& event)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_events.size() < TIMELINE_EVENTS || event.phase == 'M')
+        _events.push_back(event);
+    else
+        _dropped++;
+}
+
+
+void Timeline::add(const char* name, clock::time_point start, const string& detail)
+{
+    if (!_enabled) return;
+
+    clock::time_point end = clock::now();
+
+    Event event;
+    event.name = name;
+    event.phase = 'X';
+    event.tid = tid();
+    event.ts = std::chrono::duration_cast<std::chrono::microseconds>(start - _start).count();
+    event.dur = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    event.detail = detail;
+    push(event);
+}
+
+
+void Timeline::nameThread(const string& name)
+{
+    if (!_enabled) return;
+
+    // pool workers are named for each item they pick up
+    static thread_local string named;
+    if (named == name) return;
+    named = name;
+
+    Event event;
+    event.name = "thread_name";
+    event.phase = 'M';
+    event.tid = tid();
+    event.ts = 0;
+    event.dur = 0;
+    event.detail = name;
+    push(event);
+}
+
+
+bool Timeline::write() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_file.empty()) return true;
+
+    string tmp = _file + ".tmp";
+    std::ofstream out(tmp.c_str());
+
+    out << "{\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [\n";
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0,"
+           " \"args\": {\"name\": \"auto_cal\"}}";
+
+    for (size_t i = 0; i < _events.size(); i++) {
+        const Event& e = _events[i];
+        out << ",\n{\"name\": " << jsonString(e.name) << ", \"ph\": \"" << e.phase
+            << "\", \"pid\": 1, \"tid\": " << e.tid;
+        if (e.phase == 'M')
+            out << ", \"args\": {\"name\": " << jsonString(e.detail) << "}}";
+        else {
+            out << ", \"ts\": " << e.ts << ", \"dur\": " << e.dur;
+            if (!e.detail.empty())
+                out << ", \"args\": {\"detail\": " << jsonString(e.detail) << "}";
+            out << "}";
+        }
+    }
+    out << "\n],\n\"otherData\": {\"dropped\": " << _dropped << "}}\n";
+    out.close();
+
+    if (!out || ::rename(tmp.c_str(), _file.c_str())) {
+        std::cout << "Timeline: cannot write " << _file << std::endl;
+        ::remove(tmp.c_str());
+        return false;
+    }
+    std::cout << "Timeline: wrote " << _events.size() << " events to " << _file;
+    if (_dropped)
+        std::cout << " (" << _dropped << " dropped once it was full)";
+    std::cout << std::endl;
+    return true;
+}
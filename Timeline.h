@@ -0,0 +1,112 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class Timeline
+ * Records when each step of a run happened and on which thread, and
+ * writes it as Chrome Trace Event JSON for chrome://tracing or Perfetto.
+ * Where RunReport keeps totals, this shows how the XML-RPC calls, the
+ * sample gathering, the fit and the GUI overlap or wait on each other.
+ *
+ * Nothing is recorded until setFile() names a file, so the spans left
+ * in the code cost one atomic load when tracing is off.
+ */
+class Timeline
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Records the time from its construction to its destruction.
+    class Span
+    {
+    public:
+        Span(Timeline& timeline, const char* name, const std::string& detail = "");
+        ~Span();
+
+    private:
+        Timeline& _timeline;
+        const char* _name;
+        std::string _detail;
+        bool _enabled;
+        clock::time_point _start;
+    };
+
+    Timeline();
+
+    /// Start recording, for write() to save in path.
+    void setFile(const std::string& path);
+
+    bool enabled() const { return _enabled; };
+
+    /// Record a span of the calling thread from start until now.
+    void add(const char* name, clock::time_point start, const std::string& detail = "");
+
+    /// Show the calling thread under this name; naming it again is cheap.
+    void nameThread(const std::string& name);
+
+    /// Write everything recorded so far; the file is replaced each time.
+    bool write() const;
+
+private:
+    struct Event {
+        const char* name;     // a string literal
+        char phase;           // 'X' for a span, 'M' for a thread name
+        unsigned int tid;
+        long long ts;         // microseconds since the timeline started
+        long long dur;
+        std::string detail;
+    };
+
+    /// Small number for the calling thread, assigned when first seen.
+    unsigned int tid();
+
+    void push(const Event& event);
+
+    std::atomic<bool> _enabled;
+
+    clock::time_point _start;
+
+    std::atomic<unsigned int> _nextTid;
+
+    mutable std::mutex _mutex;
+
+    std::vector<Event> _events;
+
+    /// spans not recorded once the timeline was full
+    unsigned long _dropped;
+
+    std::string _file;
+};
+
+#endif
@@ -176,6 +176,34 @@ int TreeModel::rowCount(const QModelIndex &parent) const
     return parentItem->childCount();
 }
 
+void TreeModel::addCard(const QString &location, const QString &dsmName, unsigned int dsmId,
+                        const QString &calFile, const QString &devName, unsigned int devId)
+{
+    TreeItem *dsmItem = 0;
+    int dsmRow;
+    for (dsmRow = 0; dsmRow < rootItem->childCount(); ++dsmRow)
+        if (rootItem->child(dsmRow)->data(2).toUInt() == dsmId) {
+            dsmItem = rootItem->child(dsmRow);
+            break;
+        }
+
+    if (!dsmItem) {
+        QList<QVariant> dsmData;
+        dsmData << location << dsmName << QString::number(dsmId);
+        beginInsertRows(QModelIndex(), dsmRow, dsmRow);
+        dsmItem = new TreeItem(dsmData, rootItem);
+        rootItem->appendChild(dsmItem);
+        endInsertRows();
+    }
+
+    QList<QVariant> devData;
+    devData << calFile << devName << QString::number(devId);
+    int devRow = dsmItem->childCount();
+    beginInsertRows(createIndex(dsmRow, 0, dsmItem), devRow, devRow);
+    dsmItem->appendChild(new TreeItem(devData, dsmItem));
+    endInsertRows();
+}
+
 void TreeModel::setupModelData(const QStringList &lines, TreeItem *parent)
 {
     QList<TreeItem*> parents;
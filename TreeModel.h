@@ -91,6 +91,10 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
 
+    // Append a card, and its DSM if this is the DSM's first card.
+    void addCard(const QString &location, const QString &dsmName, unsigned int dsmId,
+                 const QString &calFile, const QString &devName, unsigned int devId);
+
 private:
     void setupModelData(const QStringList &lines, TreeItem *parent);
 
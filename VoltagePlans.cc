@@ -0,0 +1,191 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "VoltagePlans.h"
+
+#include <fstream>
+#include <sstream>
+
+using std::string;
+
+namespace {
+
+const int SELECTABLE[] = { -99, 0, 1, 2, 5, 10, -10 };
+
+const int GPDAQ[] = { 0, 2 };
+const int LOW[]   = { 0, 1, 5 };                    // 4F, 2T and dmmat
+const int MID[]   = { 0, 1, 5, 10 };                // 2F
+const int WIDE[]  = { 0, 1, 5, 10, -10 };           // 1T
+
+#define COUNT(a) (sizeof(a) / sizeof(a[0]))
+
+/// log2 of gain, -1 for a gain with no plan
+int gainBits(int gain)
+{
+    for (int b = 0; b < PLAN_GAINS; b++)
+        if (gain == (1 << b))
+            return b;
+    return -1;
+}
+
+}
+
+
+VoltagePlans::VoltagePlans()
+{
+    for (int c = 0; c < PLAN_CODES; c++)
+        _plans[c].n = 0;
+
+    _selectable.n = COUNT(SELECTABLE);
+    for (unsigned int i = 0; i < _selectable.n; i++)
+        _selectable.levels[i] = SELECTABLE[i];
+
+    set(PLAN_GPDAQ,      GPDAQ, COUNT(GPDAQ));
+    set(PLAN_DMMAT,      LOW,   COUNT(LOW));
+    set(Code("4F"),      LOW,   COUNT(LOW));
+    set(Code("2T"),      LOW,   COUNT(LOW));
+    set(Code("2F"),      MID,   COUNT(MID));
+    set(Code("1T"),      WIDE,  COUNT(WIDE));
+}
+
+
+void VoltagePlans::set(int code, const int* levels, unsigned int n)
+{
+    Plan& plan = _plans[code];
+    plan.n = n;
+    for (unsigned int i = 0; i < n; i++)
+        plan.levels[i] = levels[i];
+}
+
+
+int VoltagePlans::Code(const string& card, int gain, int bplr)
+{
+    if (card == "gpDAQ") return PLAN_GPDAQ;
+    if (card == "dmmat") return PLAN_DMMAT;
+
+    int bits = gainBits(gain);
+    if (bits < 0)
+        return PLAN_NONE;
+    return PLAN_A2D + 2 * bits + (bplr ? 1 : 0);
+}
+
+
+int VoltagePlans::Code(const string& range)
+{
+    if (range == "gpDAQ") return PLAN_GPDAQ;
+    if (range == "dmmat") return PLAN_DMMAT;
+
+    std::istringstream ist(range);
+    int gain;
+    char polarity;
+    if (!(ist >> gain >> polarity) || ist.peek() != EOF)
+        return -1;
+    if (gainBits(gain) < 0 || (polarity != 'T' && polarity != 'F'))
+        return -1;
+    return Code("", gain, polarity == 'T');
+}
+
+
+string VoltagePlans::Name(int code)
+{
+    if (code == PLAN_GPDAQ) return "gpDAQ";
+    if (code == PLAN_DMMAT) return "dmmat";
+    if (code < PLAN_A2D || code >= PLAN_CODES) return "--";
+
+    std::ostringstream ostr;
+    ostr << (1 << (code - PLAN_A2D) / 2) << ((code - PLAN_A2D) % 2 ? "T" : "F");
+    return ostr.str();
+}
+
+
+bool VoltagePlans::load(const string& path, std::list<string>& problems)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+        return false;
+
+    string line;
+    for (int lineNo = 1; std::getline(in, line); lineNo++) {
+        size_t hash = line.find('#');
+        if (hash != string::npos)
+            line.erase(hash);
+
+        std::istringstream ist(line);
+        string range;
+        if (!(ist >> range))
+            continue;
+
+        std::ostringstream where;
+        where << path << ":" << lineNo << ": ";
+
+        int code = Code(range);
+        if (code < 0) {
+            problems.push_back(where.str() + "unknown range " + range);
+            continue;
+        }
+
+        int levels[MAX_PLAN_LEVELS];
+        unsigned int n = 0;
+        string bad;
+        int level;
+        while (ist >> level) {
+            bool known = false;
+            for (unsigned int i = 1; i < _selectable.n; i++)     // not -99
+                known |= (level == _selectable.levels[i]);
+            bool repeated = false;
+            for (unsigned int i = 0; i < n; i++)
+                repeated |= (level == levels[i]);
+
+            if (!known)
+                bad = "a card can not be set to " + std::to_string(level) + "v";
+            else if (!repeated && n < MAX_PLAN_LEVELS)
+                levels[n++] = level;
+        }
+        if (!ist.eof())
+            bad = "levels must be whole volts";
+        if (bad.empty() && n < 2)
+            bad = "a fit needs at least two levels";
+        if (!bad.empty()) {
+            problems.push_back(where.str() + range + ": " + bad);
+            continue;
+        }
+        set(code, levels, n);
+    }
+    return true;
+}
+
+
+string VoltagePlans::describe() const
+{
+    std::ostringstream ostr;
+    for (int c = PLAN_GPDAQ; c < PLAN_CODES; c++) {
+        if (_plans[c].empty()) continue;
+        ostr << Name(c);
+        for (unsigned int i = 0; i < _plans[c].n; i++)
+            ostr << " " << _plans[c].levels[i];
+        ostr << "\n";
+    }
+    return ostr.str();
+}
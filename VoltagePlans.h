@@ -0,0 +1,112 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef VOLTAGEPLANS_H
+#define VOLTAGEPLANS_H
+
+#include <list>
+#include <string>
+
+// most levels in one plan; the cards can produce no more than this
+#define MAX_PLAN_LEVELS 8
+
+// ncar_a2d gains with a plan of their own: 1, 2, 4 and 8
+#define PLAN_GAINS 4
+
+/// Plan codes: one per card type, and per gain and polarity for ncar_a2d.
+enum planCode {
+    PLAN_NONE,                                      // no variable, no levels
+    PLAN_GPDAQ,
+    PLAN_DMMAT,
+    PLAN_A2D,                                       // + 2 * log2(gain) + bipolar
+    PLAN_CODES = PLAN_A2D + 2 * PLAN_GAINS
+};
+
+/**
+ * @class VoltagePlans
+ * The calibration voltage levels used for each input range.  A range is
+ * named as the plan file and the old voltageLevels keys name it: "1T",
+ * "2F", "4F", ... (gain, then T for bipolar) for ncar_a2d, or the card
+ * type for a gpDAQ or dmmat.  A dmmat is calibrated at the levels of its
+ * gain range; its own plan is what the test page offers.  Each is compiled into a small array
+ * indexed by its planCode, so finding a channel's levels takes no string
+ * building and no copies.
+ *
+ * The built in plans can be replaced, range by range, from a plan file
+ * of lines like
+ *
+ *     # range  levels
+ *     1T       0 1 2 5 10 -10
+ *
+ * so a site can sweep more levels without a rebuild.  Levels must be ones
+ * the cards can produce, see selectable().
+ */
+class VoltagePlans
+{
+public:
+    struct Plan {
+        unsigned int n;
+        int levels[MAX_PLAN_LEVELS];
+
+        const int* begin() const { return levels; };
+        const int* end() const { return levels + n; };
+        size_t size() const { return n; };
+        bool empty() const { return n == 0; };
+    };
+
+    /// The built in plans.
+    VoltagePlans();
+
+    static int Code(const std::string& card, int gain, int bplr);
+
+    /// planCode of a range name, -1 if it names none.
+    static int Code(const std::string& range);
+
+    static std::string Name(int code);
+
+    const Plan& get(int code) const { return _plans[code]; };
+
+    /// Every level the cards can be set to, -99 (off) first; the test page has a button for each.
+    const Plan& selectable() const { return _selectable; };
+
+    /**
+     * Replace the plans of the ranges listed in path.  A line that can
+     * not be used is skipped and described in problems.  Returns false
+     * if path can not be read.
+     */
+    bool load(const std::string& path, std::list<std::string>& problems);
+
+    /// One line per range, in the plan file's format.
+    std::string describe() const;
+
+private:
+    void set(int code, const int* levels, unsigned int n);
+
+    Plan _plans[PLAN_CODES];
+
+    Plan _selectable;
+};
+
+#endif
@@ -0,0 +1,407 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#include "XmlRpcControl.h"
+
+#include <nidas/core/SocketAddrs.h>
+
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace XmlRpc;
+using std::chrono::steady_clock;
+
+// how often a caller waiting on an attempt looks for a cancel (milliseconds)
+#define CANCEL_POLL 50
+
+// an attempt's worker and its caller share one of these; the worker may outlive the caller
+struct XmlRpcControl::Call {
+    unsigned long serial;
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished;
+    bool abandoned;                    // its caller gave up waiting
+    enum rpcStatus status;
+    XmlRpcValue result;
+};
+
+
+XmlRpcControl::XmlRpcControl():
+   _canceled(false),
+   _serial(0)
+{
+    _policy.timeout = 2.0;
+    _policy.retries = 2;
+    _policy.backoff = 0.25;
+}
+
+
+const char* XmlRpcControl::describe(enum rpcStatus status)
+{
+    switch (status) {
+    case RPC_OK:          return "ok";
+    case RPC_FAULT:       return "fault";
+    case RPC_NO_RESPONSE: return "NOT responding";
+    case RPC_TIMEOUT:     return "timed out";
+    case RPC_CANCELED:    return "canceled";
+    }
+    return "unknown";
+}
+
+
+enum rpcStatus XmlRpcControl::execute(const std::string& host, const char* method,
+                                      const XmlRpcValue& params, XmlRpcValue& result)
+{
+    enum rpcStatus status = RPC_NO_RESPONSE;
+    double backoff = _policy.backoff;
+    unsigned long serial = ++_serial;
+
+    for (int i = 0; i <= _policy.retries; i++) {
+        if (i) {
+            std::cout << "xmlrpc " << host << " " << method << " "
+                      << describe(status) << ", retrying" << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                _stats[host].retries++;
+            }
+            if (pause(backoff))
+                return RPC_CANCELED;
+            backoff *= 2;
+        }
+        steady_clock::time_point start = steady_clock::now();
+        status = attempt(host, serial, method, params, result);
+        double latency =
+          std::chrono::duration<double>(steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(_statsMutex);
+        Stats& stats = _stats[host];
+        stats.calls++;
+        if (status == RPC_OK || status == RPC_FAULT) {
+            stats.answered++;
+            stats.totalLatency += latency;
+            if (latency > stats.maxLatency)
+                stats.maxLatency = latency;
+        }
+        if (status == RPC_FAULT)       stats.faults++;
+        if (status == RPC_NO_RESPONSE) stats.noResponse++;
+        if (status == RPC_TIMEOUT)     stats.timeouts++;
+
+        if (status != RPC_NO_RESPONSE && status != RPC_TIMEOUT)
+            break;
+    }
+    return status;
+}
+
+
+enum rpcStatus XmlRpcControl::attempt(const std::string& host, unsigned long serial,
+                                      const char* method,
+                                      const XmlRpcValue& params, XmlRpcValue& result)
+{
+    if (_canceled) return RPC_CANCELED;
+
+    std::shared_ptr<Call> call = std::make_shared<Call>();
+    call->serial = serial;
+    call->finished = false;
+    call->abandoned = false;
+    call->status = RPC_NO_RESPONSE;
+
+    enum rpcStatus status = takeTurn(host, method, call, result);
+    if (status != RPC_OK)
+        return status;
+    if (call->finished)
+        return call->status;            // answered late, by an earlier attempt
+
+    std::string name(method);
+    XmlRpcValue args(params);
+
+    std::thread([call, host, name, args]() mutable {
+        XmlRpcValue res;
+        enum rpcStatus status = RPC_NO_RESPONSE;
+        try {
+            XmlRpcClient client(host.c_str(), DSM_XMLRPC_PORT_TCP, "/RPC2");
+            if (client.execute(name.c_str(), args, res))
+                status = client.isFault() ? RPC_FAULT : RPC_OK;
+            client.close();
+        }
+        catch (...) {
+            status = RPC_NO_RESPONSE;
+        }
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->status = status;
+        call->result = res;
+        call->finished = true;
+        call->done.notify_all();
+    }).detach();
+
+    // the deadline starts now that the command has been sent
+    steady_clock::time_point deadline = steady_clock::now() +
+      std::chrono::duration_cast<steady_clock::duration>(
+        std::chrono::duration<double>(_policy.timeout));
+
+    status = wait(*call, deadline);
+    if (status == RPC_TIMEOUT || status == RPC_CANCELED) {
+        // still holds the DSM until it finishes
+        std::lock_guard<std::mutex> lock(call->mutex);
+        if (!call->finished) {
+            call->abandoned = true;
+            return status;
+        }
+        status = call->status;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_callsMutex);
+        std::map<std::string, std::shared_ptr<Call> >::iterator iC = _calls.find(host);
+        if (iC != _calls.end() && iC->second == call)
+            _calls.erase(iC);
+    }
+    _turn.notify_all();
+
+    std::lock_guard<std::mutex> lock(call->mutex);
+    result = call->result;
+    return status;
+}
+
+
+enum rpcStatus XmlRpcControl::takeTurn(const std::string& host, const char* method,
+                                       const std::shared_ptr<Call>& call,
+                                       XmlRpcValue& result)
+{
+    std::unique_lock<std::mutex> lock(_callsMutex);
+    std::list<Call*>& waiting = _waiting[host];
+    waiting.push_back(call.get());
+
+    // how long the DSM has been held by a command whose caller gave up
+    std::shared_ptr<Call> stuck;
+    steady_clock::time_point stuckSince;
+
+    enum rpcStatus status = RPC_OK;
+    for (;;) {
+        if (_canceled) {
+            status = RPC_CANCELED;
+            break;
+        }
+        std::shared_ptr<Call>& slot = _calls[host];
+        bool busy = false;
+        if (slot) {
+            std::lock_guard<std::mutex> lockSlot(slot->mutex);
+            if (!slot->finished) {
+                busy = true;
+                if (!slot->abandoned)
+                    stuck.reset();
+                else if (stuck != slot) {
+                    stuck = slot;
+                    stuckSince = steady_clock::now();
+                }
+            }
+            // An earlier attempt of this call got an answer after all: the
+            // command has been run, so use its answer and don't send it again.
+            else if (slot->serial == call->serial &&
+                (slot->status == RPC_OK || slot->status == RPC_FAULT)) {
+                std::cout << "xmlrpc " << host << " " << method
+                          << " answered late" << std::endl;
+                result = slot->result;
+                call->status = slot->status;
+                call->finished = true;
+                slot.reset();
+                break;
+            }
+        }
+        if (!busy && waiting.front() == call.get()) {
+            slot = call;
+            break;
+        }
+        if (stuck && steady_clock::now() - stuckSince >=
+              std::chrono::duration<double>(_policy.timeout)) {
+            status = RPC_TIMEOUT;
+            break;
+        }
+        _turn.wait_for(lock, std::chrono::milliseconds(CANCEL_POLL));
+    }
+    waiting.remove(call.get());
+    lock.unlock();
+    _turn.notify_all();
+
+    return status;
+}
+
+
+enum rpcStatus XmlRpcControl::wait(Call& call, steady_clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(call.mutex);
+    while (!call.finished) {
+        if (_canceled) return RPC_CANCELED;
+
+        steady_clock::time_point now = steady_clock::now();
+        if (now >= deadline) return RPC_TIMEOUT;
+
+        call.done.wait_until(lock,
+          std::min(deadline, now + std::chrono::milliseconds(CANCEL_POLL)));
+    }
+    return call.status;
+}
+
+
+bool XmlRpcControl::pause(double seconds)
+{
+    steady_clock::time_point until = steady_clock::now() +
+      std::chrono::duration_cast<steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+
+    while (steady_clock::now() < until) {
+        if (_canceled) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(CANCEL_POLL));
+    }
+    return _canceled;
+}
+
+
+std::map<std::string, XmlRpcControl::Stats> XmlRpcControl::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    return _stats;
+}
+
+
+void XmlRpcControl::report() const
+{
+    std::map<std::string, Stats> stats = getStats();
+    if (stats.empty()) return;
+
+    std::cout << "xmlrpc per DSM:      calls  mean ms   max ms  timeouts  no resp  retries  faults"
+              << std::endl;
+
+    std::streamsize precision = std::cout.precision();
+
+    std::map<std::string, Stats>::const_iterator iS;
+    for (iS = stats.begin(); iS != stats.end(); iS++) {
+        const Stats& s = iS->second;
+        double mean = s.answered ? s.totalLatency / s.answered : 0.0;
+
+        std::cout << "  " << std::left << std::setw(16) << iS->first << std::right
+                  << std::setw(8) << s.calls
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(9) << mean * 1000.0
+                  << std::setw(9) << s.maxLatency * 1000.0
+                  << std::setw(10) << s.timeouts
+                  << std::setw(9) << s.noResponse
+                  << std::setw(9) << s.retries
+                  << std::setw(8) << s.faults << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout.precision(precision);
+}
+
+
+// Try a non-blocking connect to host's XML-RPC port, giving up at deadline.
+static bool probe(const std::string& host, steady_clock::time_point deadline)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addrs = 0;
+    std::string port = std::to_string(DSM_XMLRPC_PORT_TCP);
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs) || addrs == 0)
+        return false;
+
+    bool reachable = false;
+    int fd = ::socket(addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol);
+    if (fd >= 0) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        if (::connect(fd, addrs->ai_addr, addrs->ai_addrlen) == 0)
+            reachable = true;
+        else if (errno == EINPROGRESS) {
+            int ms = std::chrono::duration_cast<std::chrono::milliseconds>
+                       (deadline - steady_clock::now()).count();
+
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (ms > 0 && ::poll(&pfd, 1, ms) == 1 &&
+                ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+                reachable = true;
+        }
+        ::close(fd);
+    }
+    ::freeaddrinfo(addrs);
+
+    return reachable;
+}
+
+
+std::set<std::string> XmlRpcControl::Reachable(const std::list<std::string>& hosts,
+                                               double timeout)
+{
+    // shared with the probes, which may outlive this call while
+    // stuck resolving a name
+    struct Sweep {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::set<std::string> reachable;
+        size_t finished;
+    };
+    std::shared_ptr<Sweep> sweep = std::make_shared<Sweep>();
+    sweep->finished = 0;
+
+    steady_clock::time_point deadline = steady_clock::now() +
+      std::chrono::duration_cast<steady_clock::duration>(
+        std::chrono::duration<double>(timeout));
+
+    std::list<std::string>::const_iterator iH;
+    for (iH = hosts.begin(); iH != hosts.end(); iH++) {
+        std::string host = *iH;
+        std::thread([sweep, host, deadline]() {
+            bool reachable = probe(host, deadline);
+
+            std::lock_guard<std::mutex> lock(sweep->mutex);
+            if (reachable)
+                sweep->reachable.insert(host);
+            sweep->finished++;
+            sweep->done.notify_all();
+        }).detach();
+    }
+    std::unique_lock<std::mutex> lock(sweep->mutex);
+    sweep->done.wait_until(lock, deadline,
+                           [&] { return sweep->finished == hosts.size(); });
+
+    return sweep->reachable;
+}
@@ -0,0 +1,162 @@
+/* -*- mode: C++; indent-tabs-mode: nil; c-basic-offset: 4; tab-width: 4; -*- */
+/* vim: set shiftwidth=4 softtabstop=4 expandtab: */
+/*
+ ********************************************************************
+ ** NIDAS: NCAR In-situ Data Acquistion Software
+ **
+ ** 2026, Copyright University Corporation for Atmospheric Research
+ **
+ ** This program is free software; you can redistribute it and/or modify
+ ** it under the terms of the GNU General Public License as published by
+ ** the Free Software Foundation; either version 2 of the License, or
+ ** (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ ** GNU General Public License for more details.
+ **
+ ** The LICENSE.txt file accompanying this software contains
+ ** a copy of the GNU General Public License. If it is not found,
+ ** write to the Free Software Foundation, Inc.,
+ ** 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **
+ ********************************************************************
+*/
+#ifndef XMLRPCCONTROL_H
+#define XMLRPCCONTROL_H
+
+#include <xmlrpcpp/XmlRpc.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+enum rpcStatus { RPC_OK, RPC_FAULT, RPC_NO_RESPONSE, RPC_TIMEOUT, RPC_CANCELED };
+
+/**
+ * @class XmlRpcControl
+ * Makes the XML-RPC control calls to the DSMs.  Every call carries a
+ * deadline per attempt and a bounded number of retries with exponential
+ * backoff, and can be canceled.  Each attempt runs on its own thread and
+ * connection, so a hung DSM cannot hold the caller past the deadline.
+ * An attempt that misses it is left to finish on its own, and until it
+ * does no other command is sent to that DSM: commands reach a DSM one at
+ * a time and in the order they were made, a retry picks up the late
+ * answer of the attempt it replaces rather than sending the command
+ * twice, and a hung DSM ties up one thread at most.  The deadline starts
+ * when a command is sent, not while it waits its turn; waiting on a
+ * command that was left to finish is limited to one more timeout.
+ * Latency, timeout and retry counts are kept per DSM.
+ */
+class XmlRpcControl
+{
+public:
+    struct Policy {
+        double timeout;                // seconds allowed per attempt
+        int retries;                   // extra attempts after no response or a timeout
+        double backoff;                // seconds before the first retry, doubled after
+    };
+
+    struct Stats {
+        unsigned long calls;
+        unsigned long faults;
+        unsigned long noResponse;
+        unsigned long timeouts;
+        unsigned long retries;
+        double totalLatency;           // seconds, over answered attempts
+        double maxLatency;
+        unsigned long answered;
+    };
+
+    XmlRpcControl();
+
+    void setPolicy(const Policy& policy) { _policy = policy; };
+
+    const Policy& getPolicy() const { return _policy; };
+
+    /**
+     * Call method on the DSM named host.  Faults are returned as is;
+     * no response and timeouts are retried within the policy's budget.
+     */
+    enum rpcStatus execute(const std::string& host, const char* method,
+                           const XmlRpc::XmlRpcValue& params,
+                           XmlRpc::XmlRpcValue& result);
+
+    /// Abandon calls in progress and refuse new ones until reset().
+    void cancel() { _canceled = true; };
+
+    void reset() { _canceled = false; };
+
+    /// Per DSM statistics, indexed by host.
+    std::map<std::string, Stats> getStats() const;
+
+    /// Print a table of the per DSM statistics.
+    void report() const;
+
+    static const char* describe(enum rpcStatus status);
+
+    /**
+     * Sweep the XML-RPC ports of hosts concurrently, and return those
+     * that accepted a connection within timeout seconds.  The whole
+     * sweep takes no longer than timeout, however many hosts are down.
+     */
+    static std::set<std::string> Reachable(const std::list<std::string>& hosts,
+                                           double timeout);
+
+private:
+    struct Call;
+
+    /**
+     * One attempt of call serial: wait for the DSM's turn, then send it
+     * and wait for the answer, bounded by the policy's timeout.
+     */
+    enum rpcStatus attempt(const std::string& host, unsigned long serial,
+                           const char* method,
+                           const XmlRpc::XmlRpcValue& params,
+                           XmlRpc::XmlRpcValue& result);
+
+    /// Wait for call to finish: its status, or RPC_TIMEOUT or RPC_CANCELED.
+    enum rpcStatus wait(Call& call, std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * Wait, first come first served, until host is free and take it for
+     * call, or take the late answer of an earlier attempt of the same
+     * call.  Returns RPC_OK once call holds host.
+     */
+    enum rpcStatus takeTurn(const std::string& host, const char* method,
+                            const std::shared_ptr<Call>& call,
+                            XmlRpc::XmlRpcValue& result);
+
+    /// Sleep for seconds unless canceled first.  Returns true if canceled.
+    bool pause(double seconds);
+
+    Policy _policy;
+
+    std::atomic<bool> _canceled;
+
+    std::atomic<unsigned long> _serial;
+
+    std::mutex _callsMutex;
+
+    /// Signaled when a DSM is free again.
+    std::condition_variable _turn;
+
+    /// The command each DSM is running or was last left running, by host.
+    std::map<std::string, std::shared_ptr<Call> > _calls;
+
+    /// Attempts waiting for each DSM, oldest first, by host.
+    std::map<std::string, std::list<Call*> > _waiting;
+
+    mutable std::mutex _statsMutex;
+
+    std::map<std::string, Stats> _stats;
+};
+
+#endif
@@ -36,7 +36,33 @@
 void usage()
 {
   cerr << "Usage: auto_cal [options]\n";
-  cerr << "  --help,-h       This usage info.\n\n";
+  cerr << "  --help,-h       This usage info.\n";
+  cerr << "  --threads N     Threads used to fit the results (default: one per core).\n";
+  cerr << "  --fit-benchmark Time fitting a synthetic 50 card fleet on 1 to N threads\n";
+  cerr << "                  (N from --threads, or one per core) and exit.\n";
+  cerr << "  --resume        Continue an interrupted calibration from its checkpoint.\n";
+  cerr << "  --checkpoint F  Checkpoint file (default: $HOME/.auto_cal_checkpoint).\n";
+  cerr << "  --config-cache F\n";
+  cerr << "                  Analog sensors of the XML configuration, cached for a\n";
+  cerr << "                  fast startup (default: $HOME/.auto_cal_config_cache).\n";
+  cerr << "  --error-report F\n";
+  cerr << "                  Keep a report of the problems found in F, rewritten as\n";
+  cerr << "                  each one is found (for runs with nobody watching).\n";
+  cerr << "  --trace F       Write a timeline of the run to F as Chrome Trace Event\n";
+  cerr << "                  JSON, for chrome://tracing or ui.perfetto.dev.\n";
+  cerr << "  --direct        Process raw samples in line, bypassing the sample pipeline.\n";
+  cerr << "  --level-order O Order of each card's levels: ascending, common (the levels\n";
+  cerr << "                  most cards need first, the default), swing (shortest path\n";
+  cerr << "                  in volts) or fastest (whichever simulates quickest).\n";
+  cerr << "  --voltage-plans F\n";
+  cerr << "                  Levels to calibrate each range at, as lines of a range\n";
+  cerr << "                  (1T, 2F, 4F, ..., gpDAQ or dmmat) then its levels in volts\n";
+  cerr << "                  (default: $HOME/.auto_cal_voltage_plans, if present).\n";
+  cerr << "  --plan          Find the cards and print how long calibrating them should\n";
+  cerr << "                  take, level by level, without applying any voltages.\n";
+  cerr << "  --rpc-timeout S Seconds allowed per XML-RPC attempt to a DSM (default: 2).\n";
+  cerr << "  --rpc-retries N Retries after an XML-RPC call times out (default: 2).\n\n";
+  cerr << "Send SIGUSR1 to print the samples each channel has received so far.\n\n";
 //logx::LogUsage(cerr);
 }
 
@@ -44,6 +70,8 @@ void usage()
 
 int main(int argc, char *argv[])
 {
+    std::chrono::steady_clock::time_point launchTime = std::chrono::steady_clock::now();
+
 //  logx::ParseLogArgs (argc, argv, true/*skip usage*/);
 
     // Create the application so qt can extract its options.
@@ -51,6 +79,25 @@ int main(int argc, char *argv[])
 
     // Parse arguments list
     std::vector<std::string> args(argv+1, argv+argc);
+    unsigned int resultThreads = 0;
+    bool resume = false;
+    bool direct = false;
+    bool plan = false;
+    bool fitBenchmark = false;
+    enum levelOrder order = ORDER_COMMON;
+    double rpcTimeout = -1.0;
+    int rpcRetries = -1;
+    std::string checkpointFile;
+    std::string configCacheFile;
+    std::string errorReportFile;
+    std::string traceFile;
+    std::string voltagePlansFile;
+    bool voltagePlansGiven = false;
+    if (getenv("HOME")) {
+        checkpointFile = std::string(getenv("HOME")) + "/.auto_cal_checkpoint";
+        configCacheFile = std::string(getenv("HOME")) + "/.auto_cal_config_cache";
+        voltagePlansFile = std::string(getenv("HOME")) + "/.auto_cal_voltage_plans";
+    }
     unsigned int i = 0;
     while (i < args.size())
     {
@@ -59,6 +106,69 @@ int main(int argc, char *argv[])
             usage();
             ::exit(0);
         }
+        else if (args[i] == "--threads" && i+1 < args.size())
+        {
+            resultThreads = atoi(args[++i].c_str());
+        }
+        else if (args[i] == "--resume")
+        {
+            resume = true;
+        }
+        else if (args[i] == "--checkpoint" && i+1 < args.size())
+        {
+            checkpointFile = args[++i];
+        }
+        else if (args[i] == "--config-cache" && i+1 < args.size())
+        {
+            configCacheFile = args[++i];
+        }
+        else if (args[i] == "--error-report" && i+1 < args.size())
+        {
+            errorReportFile = args[++i];
+        }
+        else if (args[i] == "--trace" && i+1 < args.size())
+        {
+            traceFile = args[++i];
+        }
+        else if (args[i] == "--voltage-plans" && i+1 < args.size())
+        {
+            voltagePlansFile = args[++i];
+            voltagePlansGiven = true;
+        }
+        else if (args[i] == "--direct")
+        {
+            direct = true;
+        }
+        else if (args[i] == "--plan")
+        {
+            plan = true;
+        }
+        else if (args[i] == "--fit-benchmark")
+        {
+            fitBenchmark = true;
+        }
+        else if (args[i] == "--level-order" && i+1 < args.size())
+        {
+            if (!LevelScheduler::parse(args[++i], order))
+            {
+                usage();
+                ::exit(1);
+            }
+        }
+        else if (args[i] == "--rpc-timeout" && i+1 < args.size())
+        {
+            rpcTimeout = atof(args[++i].c_str());
+        }
+        else if (args[i] == "--rpc-retries" && i+1 < args.size())
+        {
+            rpcRetries = atoi(args[++i].c_str());
+        }
+        else
+        {
+            usage();
+            ::exit(1);
+        }
+        i++;
     }
 
     // Install international language translator
@@ -69,8 +179,49 @@ int main(int argc, char *argv[])
         app.installTranslator(translator);
 
     AutoCalClient acc;
+    if (fitBenchmark) {
+        std::cout << acc.BenchmarkFit(50, resultThreads);
+        return 0;
+    }
+    acc.setResultThreads(resultThreads);
+    acc.setLevelOrder(order);
+    acc.setCheckpointFile(checkpointFile);
+    acc.Errors().setReportFile(errorReportFile);
+    acc.Trace().setFile(traceFile);
+    acc.Trace().nameThread("gui");
+
+    if (!voltagePlansFile.empty()) {
+        std::list<std::string> problems;
+        if (acc.Plans().load(voltagePlansFile, problems)) {
+            std::cout << "voltage plans from " << voltagePlansFile << ":\n"
+                      << acc.Plans().describe();
+        }
+        else if (voltagePlansGiven) {
+            cerr << "can not read voltage plans: " << voltagePlansFile << std::endl;
+            ::exit(1);
+        }
+        for (const std::string& problem : problems) {
+            cerr << problem << std::endl;
+            acc.Errors().post(ERR_WARNING, "", "", "voltage plan ignored", problem);
+        }
+    }
+
+    XmlRpcControl::Policy policy = acc.Control().getPolicy();
+    if (rpcTimeout > 0.0)
+        policy.timeout = rpcTimeout;
+    if (rpcRetries >= 0)
+        policy.retries = rpcRetries;
+    acc.Control().setPolicy(policy);
 
     Calibrator calibrator(&acc);
+    calibrator.setLaunchTime(launchTime);
+    calibrator.setConfigCache(configCacheFile);
+    if (resume)
+        calibrator.setResume();
+    if (direct)
+        calibrator.setDirect();
+    if (plan)
+        calibrator.setPlanOnly();
 
     CalibrationWizard wizard(&calibrator, &acc);
 